@@ -0,0 +1,43 @@
+# Let whisper_full() decode a spectrogram supplied with whisper_set_mel().
+#
+# whisper.cpp v1.5.5 recomputes the log-mel from PCM at the start of
+# every whisper_full() call, even when the caller already set one.  The
+# streaming partials maintain their spectrogram incrementally, so skip
+# that step when no samples are passed.  Newer whisper.cpp releases do
+# this upstream; the edit is idempotent and harmless there.
+#
+# Sets WHISPER_AGENT_HAS_SET_MEL when whisper_full() honours a preset mel.
+
+set(WHISPER_AGENT_HAS_SET_MEL OFF)
+
+foreach(CANDIDATE "${whisper_SOURCE_DIR}/whisper.cpp" "${whisper_SOURCE_DIR}/src/whisper.cpp")
+    if(EXISTS "${CANDIDATE}")
+        set(WHISPER_CPP_SOURCE "${CANDIDATE}")
+        break()
+    endif()
+endforeach()
+
+if(WHISPER_CPP_SOURCE)
+    file(READ "${WHISPER_CPP_SOURCE}" WHISPER_CPP_TEXT)
+    set(MEL_CALL "whisper_pcm_to_mel_with_state(ctx, state, samples, n_samples, params.n_threads) != 0")
+
+    if(WHISPER_CPP_TEXT MATCHES "if \\(n_samples > 0\\)"
+       OR WHISPER_CPP_TEXT MATCHES "n_samples > 0 && whisper_pcm_to_mel_with_state")
+        set(WHISPER_AGENT_HAS_SET_MEL ON)
+    else()
+        string(FIND "${WHISPER_CPP_TEXT}" "if (${MEL_CALL})" MEL_CALL_POS)
+        if(NOT MEL_CALL_POS EQUAL -1)
+            message(STATUS "Patching whisper.cpp: skip pcm_to_mel when n_samples == 0")
+            string(REPLACE "if (${MEL_CALL})" "if (n_samples > 0 && ${MEL_CALL})"
+                   WHISPER_CPP_TEXT "${WHISPER_CPP_TEXT}")
+            file(WRITE "${WHISPER_CPP_SOURCE}" "${WHISPER_CPP_TEXT}")
+            set(WHISPER_AGENT_HAS_SET_MEL ON)
+        endif()
+    endif()
+endif()
+
+if(NOT WHISPER_AGENT_HAS_SET_MEL)
+    message(WARNING
+        "Could not make whisper_full() accept a precomputed spectrogram; "
+        "streaming partials will recompute the log-mel every pass.")
+endif()
@@ -21,6 +21,9 @@ mkdir -p "$BIN_DIR" "$ICON_DIR" "$DESKTOP_DIR"
 
 # Binary
 install -m 755 "$SCRIPT_DIR/build/whisper-agent" "$BIN_DIR/whisper-agent"
+if [ -f "$SCRIPT_DIR/build/whisper-agent-worker" ]; then
+    install -m 755 "$SCRIPT_DIR/build/whisper-agent-worker" "$BIN_DIR/whisper-agent-worker"
+fi
 
 # Icon
 install -m 644 "$SCRIPT_DIR/assets/whisper-agent.svg" "$ICON_DIR/whisper-agent.svg"
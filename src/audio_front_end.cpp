@@ -0,0 +1,177 @@
+#include "audio_front_end.h"
+
+#include <cmath>
+#include <numeric>
+
+static constexpr size_t LANES            = 8;       // accumulators in the FIR dot product
+static constexpr size_t TAPS_PER_RATIO   = 24;      // taps per phase per unit of decimation
+static constexpr double PASSBAND_FRACTION = 0.88;   // cutoff as a fraction of the output Nyquist
+static constexpr double HIGHPASS_HZ      = 60.0;    // below voice fundamentals
+static constexpr size_t AGC_FRAME        = AudioFrontEnd::OUT_RATE / 100;  // 10 ms
+static constexpr float  AGC_TARGET_RMS   = 0.1f;    // −20 dBFS speech level
+static constexpr float  AGC_GATE_RMS     = 0.0018f; // −55 dBFS; quieter frames hold the gain
+static constexpr float  AGC_MIN_GAIN     = 0.25f;
+static constexpr float  AGC_MAX_GAIN     = 8.0f;    // +18 dB
+static constexpr float  AGC_LEVEL_DECAY  = 0.995f;  // per frame: level falls ~4 dB/s between words
+static constexpr float  AGC_GAIN_RISE    = 1.01f;   // per frame: gain rises ≤ ~9 dB/s
+static constexpr float  AGC_GAIN_FALL    = 0.7f;    // per frame: gain drops fast to avoid clipping
+
+AudioFrontEnd::AudioFrontEnd() {
+    Configure(OUT_RATE, 1);
+}
+
+void AudioFrontEnd::Configure(uint32_t sampleRate, uint32_t channels) {
+    m_channels = std::max(1u, channels);
+    if (sampleRate == 0) sampleRate = OUT_RATE;
+
+    uint32_t g = std::gcd(sampleRate, OUT_RATE);
+    m_up   = OUT_RATE / g;
+    m_down = sampleRate / g;
+
+    if (m_up == 1 && m_down == 1) {
+        m_taps = 0;
+        m_coeffs.clear();
+    } else {
+        // Windowed-sinc prototype at L × the input rate.  Longer when
+        // decimating, so the transition band stays narrow in Hz.
+        size_t ratio = (m_down + m_up - 1) / m_up;
+        m_taps = ((TAPS_PER_RATIO * std::max<size_t>(1, ratio) + LANES - 1) / LANES) * LANES;
+
+        const size_t n      = m_taps * m_up;
+        const double proto  = static_cast<double>(sampleRate) * m_up;
+        const double cutoff = PASSBAND_FRACTION * 0.5 * std::min(sampleRate, OUT_RATE) / proto;
+        const double mid    = (n - 1) / 2.0;
+
+        m_coeffs.assign(n, 0.0f);
+        for (size_t i = 0; i < n; ++i) {
+            double t    = i - mid;
+            double sinc = t == 0.0 ? 2.0 * cutoff
+                                   : std::sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+            double w    = 0.42 - 0.5 * std::cos(2.0 * M_PI * i / (n - 1))
+                        + 0.08 * std::cos(4.0 * M_PI * i / (n - 1));   // Blackman
+            // Tap j of phase p is prototype tap j·L + p; store reversed.
+            size_t p = i % m_up, j = i / m_up;
+            m_coeffs[p * m_taps + (m_taps - 1 - j)] = static_cast<float>(sinc * w * m_up);
+        }
+    }
+
+    size_t history = m_taps > 0 ? m_taps - 1 : 0;
+    m_mono.assign(history + BLOCK_FRAMES, 0.0f);
+    m_index = history;
+    m_phase = 0;
+    m_out.assign(BLOCK_FRAMES * m_up / m_down + 2, 0.0f);
+
+    m_hpCoeff   = static_cast<float>(std::exp(-2.0 * M_PI * HIGHPASS_HZ / OUT_RATE));
+    m_hpPrevIn  = m_hpPrevOut = 0.0f;
+
+    m_gain      = 1.0f;
+    m_level     = 0.0f;
+    m_frameSum  = 0.0f;
+    m_frameFill = 0;
+}
+
+size_t AudioFrontEnd::ProcessBlock(const float* in, size_t frames) {
+    size_t history = m_taps > 0 ? m_taps - 1 : 0;
+    float* mono = m_mono.data() + history;
+
+    if (m_channels == 1) {
+        std::copy(in, in + frames, mono);
+    } else {
+        const float k = 1.0f / static_cast<float>(m_channels);
+        for (size_t i = 0; i < frames; ++i) {
+            float sum = 0.0f;
+            for (uint32_t c = 0; c < m_channels; ++c)
+                sum += in[i * m_channels + c];
+            mono[i] = sum * k;
+        }
+    }
+
+    size_t n = Resample(frames);
+    HighPass(m_out.data(), n);
+    if (m_autoGain)
+        AutoGain(m_out.data(), n);
+    return n;
+}
+
+size_t AudioFrontEnd::Resample(size_t frames) {
+    if (m_taps == 0) {
+        std::copy(m_mono.begin(), m_mono.begin() + frames, m_out.begin());
+        return frames;
+    }
+
+    const size_t history = m_taps - 1;
+    const size_t end     = history + frames;
+    const float* x       = m_mono.data();
+    size_t produced = 0;
+
+    while (m_index < end && produced < m_out.size()) {
+        const float* __restrict h = m_coeffs.data() + static_cast<size_t>(m_phase) * m_taps;
+        const float* __restrict s = x + m_index - history;
+
+        // Independent lane accumulators let the compiler use packed
+        // multiply-adds without reassociating one serial float sum.
+        float acc[LANES] = {};
+        for (size_t j = 0; j < m_taps; j += LANES)
+            for (size_t l = 0; l < LANES; ++l)
+                acc[l] += h[j + l] * s[j + l];
+        float y = 0.0f;
+        for (size_t l = 0; l < LANES; ++l) y += acc[l];
+        m_out[produced++] = y;
+
+        m_phase += m_down;
+        m_index += m_phase / m_up;
+        m_phase %= m_up;
+    }
+
+    // Slide the last taps−1 samples to the front for the next block.
+    std::copy(m_mono.begin() + frames, m_mono.begin() + end, m_mono.begin());
+    m_index -= frames;
+    return produced;
+}
+
+void AudioFrontEnd::HighPass(float* x, size_t n) {
+    // y[n] = a·(y[n−1] + x[n] − x[n−1])
+    const float a = m_hpCoeff;
+    float prevIn = m_hpPrevIn, prevOut = m_hpPrevOut;
+    for (size_t i = 0; i < n; ++i) {
+        float y = a * (prevOut + x[i] - prevIn);
+        prevIn  = x[i];
+        prevOut = y;
+        x[i]    = y;
+    }
+    m_hpPrevIn  = prevIn;
+    m_hpPrevOut = prevOut;
+}
+
+void AudioFrontEnd::AutoGain(float* x, size_t n) {
+    // The gain is updated once per 10 ms frame and ramped linearly across
+    // the next one, so changes don't click.
+    size_t i = 0;
+    while (i < n) {
+        size_t take  = std::min(n - i, AGC_FRAME - m_frameFill);
+        float  start = m_gain;
+
+        for (size_t k = 0; k < take; ++k)
+            m_frameSum += x[i + k] * x[i + k];
+        m_frameFill += take;
+
+        if (m_frameFill == AGC_FRAME) {
+            float rms = std::sqrt(m_frameSum / AGC_FRAME);
+            m_level = std::max(rms, m_level * AGC_LEVEL_DECAY);
+            if (rms > AGC_GATE_RMS) {
+                float want = std::clamp(AGC_TARGET_RMS / m_level, AGC_MIN_GAIN, AGC_MAX_GAIN);
+                m_gain = want < m_gain ? std::max(want, m_gain * AGC_GAIN_FALL)
+                                       : std::min(want, m_gain * AGC_GAIN_RISE);
+            }
+            m_frameSum  = 0.0f;
+            m_frameFill = 0;
+        }
+
+        float step = take > 0 ? (m_gain - start) / static_cast<float>(take) : 0.0f;
+        for (size_t k = 0; k < take; ++k) {
+            float g = start + step * static_cast<float>(k + 1);
+            x[i + k] = std::clamp(x[i + k] * g, -1.0f, 1.0f);
+        }
+        i += take;
+    }
+}
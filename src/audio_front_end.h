@@ -0,0 +1,80 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Capture front-end: turns whatever the device delivers into the 16 kHz
+/// mono signal whisper wants, and conditions it on the way.
+///
+///  - downmix interleaved channels to mono
+///  - resample with a windowed-sinc polyphase filter (pass-through at 16 kHz)
+///  - remove DC and rumble with a first-order high-pass
+///  - automatic gain control, so quiet microphones reach a level whisper
+///    decodes well; gain only moves while there's signal above the
+///    noise gate, so silence isn't pumped up
+///
+/// Configure() allocates; Process() doesn't and takes no locks, so it is
+/// safe on the real-time audio thread.
+class AudioFrontEnd {
+public:
+    static constexpr uint32_t OUT_RATE     = 16000;
+    static constexpr size_t   BLOCK_FRAMES = 1024;   // input frames per internal block
+
+    AudioFrontEnd();
+
+    /// Prepare for @p sampleRate Hz input with @p channels interleaved
+    /// channels and clear all filter state.  Not real-time safe.
+    void Configure(uint32_t sampleRate, uint32_t channels);
+
+    void SetAutoGain(bool on) { m_autoGain = on; }
+
+    /// Current AGC gain (linear).  Audio thread.
+    float Gain() const { return m_gain; }
+
+    /// Process @p frames interleaved input frames; calls
+    /// @p sink(const float* samples, size_t count) with 16 kHz mono output.
+    template <typename Sink>
+    void Process(const float* in, size_t frames, Sink&& sink) {
+        while (frames > 0) {
+            size_t n   = std::min(frames, BLOCK_FRAMES);
+            size_t out = ProcessBlock(in, n);
+            if (out > 0) sink(m_out.data(), out);
+            in     += n * m_channels;
+            frames -= n;
+        }
+    }
+
+private:
+    size_t ProcessBlock(const float* in, size_t frames);
+    size_t Resample(size_t frames);
+    void   HighPass(float* x, size_t n);
+    void   AutoGain(float* x, size_t n);
+
+    uint32_t m_channels = 1;
+    bool     m_autoGain = true;
+
+    // Polyphase resampler: output m reads input at m·M/L.  Each phase's
+    // taps are stored reversed and padded to a multiple of the lane
+    // count so the dot product runs over contiguous memory.
+    uint32_t           m_up    = 1;      // L
+    uint32_t           m_down  = 1;      // M
+    size_t             m_taps  = 0;      // per phase, 0 → pass-through
+    std::vector<float> m_coeffs;         // m_up × m_taps
+    std::vector<float> m_mono;           // (m_taps - 1) history + BLOCK_FRAMES
+    size_t             m_index = 0;      // newest input sample for the next output
+    uint32_t           m_phase = 0;
+    std::vector<float> m_out;
+
+    // High-pass state
+    float m_hpCoeff = 0.0f;
+    float m_hpPrevIn  = 0.0f;
+    float m_hpPrevOut = 0.0f;
+
+    // AGC state
+    float  m_gain      = 1.0f;
+    float  m_level     = 0.0f;   // tracked speech level (linear RMS)
+    float  m_frameSum  = 0.0f;   // energy of the partial 10 ms frame
+    size_t m_frameFill = 0;
+};
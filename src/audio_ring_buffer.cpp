@@ -0,0 +1,64 @@
+#include "audio_ring_buffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+static size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+AudioRingBuffer::AudioRingBuffer(size_t capacity)
+    : m_data(new float[roundUpPow2(std::max<size_t>(capacity, 2))])
+    , m_mask(roundUpPow2(std::max<size_t>(capacity, 2)) - 1)
+{}
+
+size_t AudioRingBuffer::Write(const float* data, size_t count) {
+    const size_t w = m_writePos.load(std::memory_order_relaxed);
+    const size_t r = m_readPos.load(std::memory_order_acquire);
+    const size_t space = Capacity() - (w - r);
+
+    size_t n = std::min(count, space);
+    if (n < count)
+        m_dropped.fetch_add(count - n, std::memory_order_relaxed);
+    if (n == 0) return 0;
+
+    // Copy in at most two contiguous spans (wrap-around).
+    size_t idx   = w & m_mask;
+    size_t first = std::min(n, Capacity() - idx);
+    std::memcpy(m_data.get() + idx, data, first * sizeof(float));
+    if (n > first)
+        std::memcpy(m_data.get(), data + first, (n - first) * sizeof(float));
+
+    m_writePos.store(w + n, std::memory_order_release);
+    return n;
+}
+
+size_t AudioRingBuffer::Read(float* out, size_t maxCount) {
+    const size_t r = m_readPos.load(std::memory_order_relaxed);
+    const size_t w = m_writePos.load(std::memory_order_acquire);
+
+    size_t n = std::min(maxCount, w - r);
+    if (n == 0) return 0;
+
+    size_t idx   = r & m_mask;
+    size_t first = std::min(n, Capacity() - idx);
+    std::memcpy(out, m_data.get() + idx, first * sizeof(float));
+    if (n > first)
+        std::memcpy(out + first, m_data.get(), (n - first) * sizeof(float));
+
+    m_readPos.store(r + n, std::memory_order_release);
+    return n;
+}
+
+size_t AudioRingBuffer::Available() const {
+    return m_writePos.load(std::memory_order_acquire)
+         - m_readPos.load(std::memory_order_relaxed);
+}
+
+void AudioRingBuffer::Reset() {
+    m_readPos.store(m_writePos.load(std::memory_order_acquire),
+                    std::memory_order_release);
+    m_dropped.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/// Lock-free single-producer / single-consumer ring buffer of PCM samples.
+///
+/// Storage is allocated once in the constructor.  Write() never blocks or
+/// allocates, so it is safe to call from the real-time audio callback;
+/// Read() is called from exactly one consumer thread.  When the consumer
+/// falls behind and the ring fills up, new samples are dropped rather
+/// than overwriting ones the consumer hasn't seen yet.
+class AudioRingBuffer {
+public:
+    /// @param capacity  Minimum number of samples; rounded up to a power of two.
+    explicit AudioRingBuffer(size_t capacity);
+
+    AudioRingBuffer(const AudioRingBuffer&) = delete;
+    AudioRingBuffer& operator=(const AudioRingBuffer&) = delete;
+
+    /// Producer side.  Returns the number of samples actually stored.
+    size_t Write(const float* data, size_t count);
+
+    /// Consumer side.  Copies up to @p maxCount samples into @p out and
+    /// returns how many were read.
+    size_t Read(float* out, size_t maxCount);
+
+    /// Samples currently waiting to be read (consumer side).
+    size_t Available() const;
+
+    /// Total samples dropped because the ring was full.
+    size_t Dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+    /// Discard everything.  Only call while no producer is running.
+    void Reset();
+
+    size_t Capacity() const { return m_mask + 1; }
+
+private:
+    std::unique_ptr<float[]> m_data;
+    size_t                   m_mask = 0;
+
+    // Monotonic positions; the index into m_data is (pos & m_mask).
+    // Kept on separate cache lines so producer and consumer don't
+    // bounce the same line between cores.
+    alignas(64) std::atomic<size_t> m_writePos{0};
+    alignas(64) std::atomic<size_t> m_readPos{0};
+    alignas(64) std::atomic<size_t> m_dropped{0};
+};
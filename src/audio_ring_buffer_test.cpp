@@ -0,0 +1,126 @@
+// Checks AudioRingBuffer's wrap-around and drop accounting.
+//
+// Writes and reads of uneven sizes push the positions around the ring
+// many times, so every copy eventually splits at the end of the
+// storage; the samples must come out in order, and whatever didn't fit
+// must be counted as dropped rather than overwrite unread audio.  A
+// second pass does the same with the producer and consumer on their own
+// threads.
+//
+//   whisper-agent-ring-test
+
+#include "audio_ring_buffer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+static constexpr size_t CAPACITY     = 1000;      // rounded up to 1024
+static constexpr size_t STRESS_TOTAL = 2000000;   // samples through the threaded pass
+
+static int failures = 0;
+
+static void check(bool ok, const char* what, size_t got, size_t want) {
+    std::printf("%s %-36s %zu (expected %zu)\n", ok ? "ok  " : "FAIL", what, got, want);
+    if (!ok) ++failures;
+}
+
+/// Samples are numbered (exact in a float up to 2^24), so order and
+/// loss are easy to see.
+static std::vector<float> numbered(size_t first, size_t count) {
+    std::vector<float> v(count);
+    for (size_t i = 0; i < count; ++i) v[i] = static_cast<float>(first + i);
+    return v;
+}
+
+static void wrapAround() {
+    AudioRingBuffer ring(CAPACITY);
+    check(ring.Capacity() == 1024, "capacity rounded to a power of two", ring.Capacity(), 1024);
+
+    const size_t writes[] = {1, 300, 777, 64, 1023, 5};
+    size_t written = 0, read = 0, misordered = 0;
+    std::vector<float> out(ring.Capacity());
+    for (int round = 0; round < 200; ++round) {
+        auto in = numbered(written, std::min(writes[round % 6], ring.Capacity() - ring.Available()));
+        written += ring.Write(in.data(), in.size());
+
+        size_t n = ring.Read(out.data(), std::min<size_t>(out.size(), 1 + round * 37 % 900));
+        for (size_t i = 0; i < n; ++i)
+            if (out[i] != static_cast<float>(read + i)) ++misordered;
+        read += n;
+    }
+    size_t n;
+    while ((n = ring.Read(out.data(), out.size())) > 0) {
+        for (size_t i = 0; i < n; ++i)
+            if (out[i] != static_cast<float>(read + i)) ++misordered;
+        read += n;
+    }
+    check(misordered == 0, "samples in order across wraps", misordered, 0);
+    check(read == written, "everything stored is read back", read, written);
+    check(ring.Dropped() == 0, "nothing dropped while draining", ring.Dropped(), 0);
+}
+
+static void dropWhenFull() {
+    AudioRingBuffer ring(CAPACITY);
+    auto in = numbered(0, 700);
+    ring.Write(in.data(), in.size());
+    size_t stored = ring.Write(in.data(), in.size());
+    check(stored == 324, "second write keeps what fits", stored, 324);
+    check(ring.Dropped() == 376, "the rest counted as dropped", ring.Dropped(), 376);
+
+    stored = ring.Write(in.data(), in.size());
+    check(stored == 0, "full ring stores nothing", stored, 0);
+    check(ring.Dropped() == 1076, "and counts all of it", ring.Dropped(), 1076);
+
+    // The oldest audio survives; the overflow never overwrote it.
+    std::vector<float> out(1024);
+    size_t n = ring.Read(out.data(), out.size());
+    bool intact = n == 1024 && out[0] == 0.0f && out[699] == 699.0f && out[700] == 0.0f;
+    check(intact, "unread samples not overwritten", n, 1024);
+
+    ring.Reset();
+    check(ring.Dropped() == 0 && ring.Available() == 0, "reset clears both", ring.Dropped(), 0);
+}
+
+static void threaded() {
+    AudioRingBuffer ring(CAPACITY);
+    size_t stored = 0;
+    std::thread producer([&] {
+        size_t pos = 0;
+        while (pos < STRESS_TOTAL) {
+            size_t count = std::min<size_t>(STRESS_TOTAL - pos, 1 + pos % 311);
+            auto in = numbered(pos, count);
+            stored += ring.Write(in.data(), count);
+            pos += count;
+            std::this_thread::yield();   // interleave even on one core
+        }
+    });
+
+    // Drops make gaps, but what arrives must never go backwards.
+    std::vector<float> out(512);
+    size_t seen = 0, backwards = 0;
+    float  last = -1.0f;
+    bool   done = false;
+    while (!done || ring.Available() > 0) {
+        done = seen + ring.Dropped() >= STRESS_TOTAL;
+        size_t n = ring.Read(out.data(), 1 + seen % out.size());
+        for (size_t i = 0; i < n; ++i) {
+            if (out[i] <= last) ++backwards;
+            last = out[i];
+        }
+        seen += n;
+    }
+    producer.join();
+    check(backwards == 0, "threaded: no sample out of order", backwards, 0);
+    check(seen == stored, "threaded: read == stored", seen, stored);
+    check(seen + ring.Dropped() == STRESS_TOTAL, "threaded: read + dropped == written",
+          seen + ring.Dropped(), STRESS_TOTAL);
+}
+
+int main() {
+    wrapAround();
+    dropWhenFull();
+    threaded();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,134 @@
+#include "audio_store.h"
+
+#include <algorithm>
+#include <cmath>
+
+struct AudioView::Chunk {
+    AudioStore::Format   format;
+    std::vector<float>   f32;   // exactly one of these is allocated
+    std::vector<int16_t> s16;
+};
+
+static constexpr float INT16_SCALE = 32767.0f;
+
+// Plain indexed loops over restrict pointers so the compiler turns both
+// conversions into packed SIMD.
+static void floatToInt16(const float* __restrict in, int16_t* __restrict out, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        float v = std::min(1.0f, std::max(-1.0f, in[i])) * INT16_SCALE;
+        out[i] = static_cast<int16_t>(std::lrintf(v));
+    }
+}
+
+static void int16ToFloat(const int16_t* __restrict in, float* __restrict out, size_t n) {
+    const float k = 1.0f / INT16_SCALE;
+    for (size_t i = 0; i < n; ++i)
+        out[i] = static_cast<float>(in[i]) * k;
+}
+
+// ============================================================================
+// AudioView
+// ============================================================================
+
+const float* AudioView::Data() const {
+    if (m_external) return m_external;
+    if (m_chunks.size() == 1 && m_chunks.front()->format == AudioStore::Format::Float32)
+        return m_chunks.front()->f32.data() + m_offset;
+    return nullptr;
+}
+
+void AudioView::CopyTo(float* out) const {
+    if (m_external) {
+        std::copy(m_external, m_external + m_count, out);
+        return;
+    }
+
+    size_t offset = m_offset, left = m_count;
+    for (const auto& chunk : m_chunks) {
+        if (left == 0) break;
+        size_t n = std::min(left, AudioStore::CHUNK_SAMPLES - offset);
+        if (chunk->format == AudioStore::Format::Int16)
+            int16ToFloat(chunk->s16.data() + offset, out, n);
+        else
+            std::copy(chunk->f32.data() + offset, chunk->f32.data() + offset + n, out);
+        out    += n;
+        left   -= n;
+        offset  = 0;
+    }
+}
+
+// ============================================================================
+// AudioStore
+// ============================================================================
+
+AudioStore::AudioStore(Format format)
+    : m_format(format)
+{}
+
+std::shared_ptr<AudioStore::Chunk> AudioStore::NewChunk() {
+    if (!m_pool.empty()) {
+        auto chunk = std::move(m_pool.back());
+        m_pool.pop_back();
+        return chunk;
+    }
+    auto chunk = std::make_shared<Chunk>();
+    chunk->format = m_format;
+    if (m_format == Format::Int16)
+        chunk->s16.resize(CHUNK_SAMPLES);
+    else
+        chunk->f32.resize(CHUNK_SAMPLES);
+    return chunk;
+}
+
+void AudioStore::Reset(Format format) {
+    Release(m_end);
+    m_chunks.clear();
+    if (format != m_format)
+        m_pool.clear();
+    m_format = format;
+    m_base = m_end = 0;
+}
+
+void AudioStore::Append(const float* samples, size_t count) {
+    while (count > 0) {
+        size_t used = (m_end - m_base) % CHUNK_SAMPLES;
+        if (used == 0 && m_end - m_base == m_chunks.size() * CHUNK_SAMPLES)
+            m_chunks.push_back(NewChunk());
+
+        Chunk& chunk = *m_chunks.back();
+        size_t n = std::min(count, CHUNK_SAMPLES - used);
+        if (m_format == Format::Int16)
+            floatToInt16(samples, chunk.s16.data() + used, n);
+        else
+            std::copy(samples, samples + n, chunk.f32.data() + used);
+        samples += n;
+        count   -= n;
+        m_end   += n;
+    }
+}
+
+void AudioStore::Release(size_t index) {
+    size_t whole = (std::min(index, m_end) - m_base) / CHUNK_SAMPLES;
+    for (size_t i = 0; i < whole; ++i) {
+        // A chunk still referenced by a snapshot stays with that
+        // snapshot; only unshared ones can be recycled.
+        if (m_chunks[i].use_count() == 1)
+            m_pool.push_back(std::move(m_chunks[i]));
+    }
+    m_chunks.erase(m_chunks.begin(), m_chunks.begin() + whole);
+    m_base += whole * CHUNK_SAMPLES;
+}
+
+AudioView AudioStore::Snapshot(size_t begin, size_t end) const {
+    AudioView view;
+    begin = std::max(begin, m_base);
+    end   = std::min(end, m_end);
+    if (begin >= end) return view;
+
+    size_t first = (begin - m_base) / CHUNK_SAMPLES;
+    size_t last  = (end - 1 - m_base) / CHUNK_SAMPLES;
+    view.m_chunks.assign(m_chunks.begin() + first, m_chunks.begin() + last + 1);
+    view.m_offset = (begin - m_base) % CHUNK_SAMPLES;
+    view.m_count  = end - begin;
+    return view;
+}
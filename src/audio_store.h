@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/// Read-only view of a range of samples: either a range of AudioStore
+/// chunks or an external float array.  Cheap to copy — it holds
+/// references to the chunks, not the samples, so a snapshot stays valid
+/// while the store keeps appending or releases the chunks it spans.
+class AudioView {
+public:
+    AudioView() = default;
+
+    /// View an external contiguous buffer (must outlive the view).
+    AudioView(const float* data, size_t count) : m_external(data), m_count(count) {}
+    AudioView(const std::vector<float>& samples)    // NOLINT: implicit on purpose
+        : AudioView(samples.data(), samples.size()) {}
+
+    size_t size() const  { return m_count; }
+    bool   empty() const { return m_count == 0; }
+
+    /// Pointer to the samples if they're contiguous float32 already,
+    /// otherwise nullptr (use CopyTo()).
+    const float* Data() const;
+
+    /// Convert the whole range to float into @p out (size() floats).
+    void CopyTo(float* out) const;
+
+private:
+    friend class AudioStore;
+    struct Chunk;
+
+    const float*                              m_external = nullptr;
+    std::vector<std::shared_ptr<const Chunk>> m_chunks;
+    size_t                                    m_offset = 0;   // into m_chunks.front()
+    size_t                                    m_count  = 0;
+};
+
+/// Append-only PCM store made of fixed-size pooled chunks.
+///
+/// Samples are addressed by their absolute index since Reset().  Appending
+/// never moves existing samples, so there is no reallocation as a
+/// session grows and Snapshot() can hand out views without copying.
+/// Chunks released from the front go back to a pool for reuse.  In
+/// Int16 mode samples are stored at half the size and converted back to
+/// float only when a view is read.  Single-threaded: one owner appends,
+/// views may be read by that owner at any later point.
+class AudioStore {
+public:
+    enum class Format { Float32, Int16 };
+
+    static constexpr size_t CHUNK_SAMPLES = 16384;   // ~1 s at 16 kHz
+
+    explicit AudioStore(Format format = Format::Float32);
+
+    Format GetFormat() const { return m_format; }
+
+    /// Drop all samples and switch to @p format.
+    void Reset(Format format);
+    void Reset() { Reset(m_format); }
+
+    void Append(const float* samples, size_t count);
+
+    /// Absolute index of the first retained sample / one past the last.
+    size_t Begin() const { return m_base; }
+    size_t End() const   { return m_end; }
+
+    /// Return whole chunks lying entirely before @p index to the pool.
+    void Release(size_t index);
+
+    /// View of [begin, end), clamped to what's retained.
+    AudioView Snapshot(size_t begin, size_t end) const;
+
+private:
+    using Chunk = AudioView::Chunk;
+
+    std::shared_ptr<Chunk> NewChunk();
+
+    Format                              m_format;
+    std::vector<std::shared_ptr<Chunk>> m_chunks;   // m_chunks[0] starts at m_base
+    std::vector<std::shared_ptr<Chunk>> m_pool;     // spare chunks of m_format
+    size_t                              m_base = 0;
+    size_t                              m_end  = 0;
+};
@@ -0,0 +1,252 @@
+#include "capture_source.h"
+#include "shared_audio_ring.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+static constexpr uint32_t REPLAY_PERIOD_MS = 20;   // frames per sink call, like a capture period
+
+// ============================================================================
+// DeviceCaptureSource
+// ============================================================================
+
+DeviceCaptureSource::~DeviceCaptureSource() {
+    Stop();
+}
+
+bool DeviceCaptureSource::Open() {
+    // 0 = the device's native rate and channel count; the Transcriber's
+    // front-end converts, not miniaudio's generic converter.
+    ma_device_config cfg = ma_device_config_init(ma_device_type_capture);
+    cfg.capture.format   = ma_format_f32;
+    cfg.capture.channels = 0;
+    cfg.sampleRate       = 0;
+    cfg.dataCallback     = DataCallback;
+    cfg.pUserData        = this;
+
+    if (ma_device_init(nullptr, &cfg, &m_device) != MA_SUCCESS)
+        return false;
+    m_init = true;
+    return true;
+}
+
+bool DeviceCaptureSource::Start(FrameSink sink) {
+    if (!m_init) return false;
+    m_sink = std::move(sink);
+    if (ma_device_start(&m_device) != MA_SUCCESS) {
+        Stop();
+        return false;
+    }
+    return true;
+}
+
+void DeviceCaptureSource::Stop() {
+    if (m_init) {
+        // ma_device_stop waits for a callback in progress to return.
+        ma_device_stop(&m_device);
+        ma_device_uninit(&m_device);
+        m_init = false;
+    }
+}
+
+void DeviceCaptureSource::DataCallback(ma_device* pDevice, void* /*pOutput*/,
+                                       const void* pInput, ma_uint32 frameCount)
+{
+    auto* self = static_cast<DeviceCaptureSource*>(pDevice->pUserData);
+    if (!pInput) return;
+    self->m_sink(static_cast<const float*>(pInput), frameCount);
+    self->m_delivered += frameCount;
+}
+
+// ============================================================================
+// FileCaptureSource
+// ============================================================================
+
+FileCaptureSource::FileCaptureSource(std::string path, Options options)
+    : m_path(std::move(path))
+    , m_options(options)
+{
+    if (m_options.speed <= 0.0) m_options.speed = 1.0;
+}
+
+FileCaptureSource::~FileCaptureSource() {
+    Stop();
+    if (m_decoderInit)
+        ma_decoder_uninit(&m_decoder);
+    if (m_rawFd >= 0 && m_rawFd != STDIN_FILENO)
+        close(m_rawFd);
+    for (int fd : m_wake)
+        if (fd >= 0) close(fd);
+}
+
+bool FileCaptureSource::Open() {
+    if (m_options.raw || m_path == "-") {
+        m_rawFd = m_path == "-" ? STDIN_FILENO : open(m_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (m_rawFd < 0) return false;
+        if (pipe2(m_wake, O_CLOEXEC) != 0) return false;
+        m_rate     = m_options.rate;
+        m_channels = std::max(1u, m_options.channels);
+        return true;
+    }
+
+    // Decode at the file's own rate and channel count, so the replay
+    // exercises the same front-end conversion as a real device.
+    ma_decoder_config cfg = ma_decoder_config_init(ma_format_f32, 0, 0);
+    if (ma_decoder_init_file(m_path.c_str(), &cfg, &m_decoder) != MA_SUCCESS)
+        return false;
+    m_decoderInit = true;
+    m_rate        = m_decoder.outputSampleRate;
+    m_channels    = m_decoder.outputChannels;
+    return true;
+}
+
+bool FileCaptureSource::Start(FrameSink sink) {
+    if (!m_decoderInit && m_rawFd < 0) return false;
+    m_stop = false;
+    m_thread = std::thread(&FileCaptureSource::Run, this, std::move(sink));
+    return true;
+}
+
+void FileCaptureSource::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    // A thread waiting on an idle pipe wakes up on the wake pipe.
+    if (m_wake[1] >= 0) {
+        char byte = 0;
+        while (write(m_wake[1], &byte, 1) < 0 && errno == EINTR) {}
+    }
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+size_t FileCaptureSource::ReadRaw(void* out, size_t bytes) {
+    // Fill the whole request, waiting on a pipe as long as it takes —
+    // but not past Stop().  Short only at end of input or when stopping.
+    auto*  p   = static_cast<char*>(out);
+    size_t got = 0;
+    while (got < bytes) {
+        pollfd fds[2] = {{m_rawFd, POLLIN, 0}, {m_wake[0], POLLIN, 0}};
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[1].revents) break;
+        ssize_t n = read(m_rawFd, p + got, bytes - got);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        got += static_cast<size_t>(n);
+    }
+    return got;
+}
+
+size_t FileCaptureSource::ReadFrames(float* out, size_t frames) {
+    if (m_decoderInit) {
+        ma_uint64 got = 0;
+        ma_decoder_read_pcm_frames(&m_decoder, out, frames, &got);
+        return static_cast<size_t>(got);
+    }
+
+    const size_t n = frames * m_channels;
+    if (m_options.rawFloat)
+        return ReadRaw(out, n * sizeof(float)) / sizeof(float) / m_channels;
+
+    m_pcm16.resize(n);
+    size_t got = ReadRaw(m_pcm16.data(), n * sizeof(int16_t)) / sizeof(int16_t);
+    for (size_t i = 0; i < got; ++i)
+        out[i] = static_cast<float>(m_pcm16[i]) / 32768.0f;
+    return got / m_channels;
+}
+
+void FileCaptureSource::Run(FrameSink sink) {
+    using Clock = std::chrono::steady_clock;
+    const size_t period = std::max<size_t>(1, m_rate * REPLAY_PERIOD_MS / 1000);
+    std::vector<float> buf(period * m_channels);
+
+    // Schedule each period against the start time so sleeps don't drift.
+    const auto start = Clock::now();
+    uint64_t   sent  = 0;
+    for (;;) {
+        size_t got = ReadFrames(buf.data(), period);
+        if (got == 0) break;
+
+        sink(buf.data(), got);
+        sent        += got;
+        m_delivered += got;
+
+        auto due = start + std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(sent / (m_rate * m_options.speed)));
+        std::unique_lock<std::mutex> lk(m_mutex);
+        if (m_cv.wait_until(lk, due, [this] { return m_stop; }))
+            return;
+    }
+    std::lock_guard<std::mutex> lk(m_mutex);
+    if (!m_stop) m_finished = true;   // not just a read cut short by Stop()
+}
+
+// ============================================================================
+// SharedRingCaptureSource
+// ============================================================================
+
+SharedRingCaptureSource::SharedRingCaptureSource(SharedAudioRing& ring, uint64_t from,
+                                                 uint32_t sampleRate, uint32_t channels)
+    : m_ring(ring)
+    , m_pos(from)
+    , m_rate(sampleRate)
+    , m_channels(channels)
+{}
+
+SharedRingCaptureSource::~SharedRingCaptureSource() {
+    Stop();
+}
+
+bool SharedRingCaptureSource::Start(FrameSink sink) {
+    if (!Open()) return false;
+    m_stop = false;
+    m_thread = std::thread(&SharedRingCaptureSource::Run, this, std::move(sink));
+    return true;
+}
+
+void SharedRingCaptureSource::Stop() {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void SharedRingCaptureSource::Forward(const FrameSink& sink, std::vector<float>& buf) {
+    uint64_t dropped = 0;
+    for (;;) {
+        size_t got = m_ring.Read(m_pos, buf.data(), buf.size(), m_channels, dropped);
+        if (got == 0) break;
+        size_t frames = got / m_channels;
+        sink(buf.data(), frames);
+        m_delivered += frames;
+    }
+    if (dropped) m_dropped += dropped;
+}
+
+void SharedRingCaptureSource::Run(FrameSink sink) {
+    const size_t period = std::max<size_t>(1, m_rate * REPLAY_PERIOD_MS / 1000);
+    std::vector<float> buf(period * m_channels);
+
+    for (;;) {
+        Forward(sink, buf);
+        std::unique_lock<std::mutex> lk(m_mutex);
+        if (m_cv.wait_for(lk, std::chrono::milliseconds(REPLAY_PERIOD_MS),
+                          [this] { return m_stop; }))
+            break;
+    }
+    Forward(sink, buf);   // the tail written before Stop()
+}
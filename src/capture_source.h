@@ -0,0 +1,163 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <miniaudio.h>
+
+class SharedAudioRing;
+
+/// Where a recording session's audio comes from.
+///
+/// A source delivers interleaved float frames to a sink from its own
+/// thread, with audio-callback rules: the sink must not block.
+/// Transcriber drives every source the same way, whether it's the
+/// microphone or a file replayed at real-time or accelerated speed.
+class CaptureSource {
+public:
+    /// (interleaved frames, frame count)
+    using FrameSink = std::function<void(const float*, size_t)>;
+
+    virtual ~CaptureSource() = default;
+
+    /// Acquire the device or file.  SampleRate() and Channels() are valid
+    /// afterwards.  Returns false on failure.
+    virtual bool Open() = 0;
+
+    /// Begin delivering frames to @p sink.  Returns false on failure.
+    virtual bool Start(FrameSink sink) = 0;
+
+    /// Stop delivering.  Idempotent; once it returns, the sink is not
+    /// called again.
+    virtual void Stop() = 0;
+
+    virtual uint32_t SampleRate() const = 0;
+    virtual uint32_t Channels() const = 0;
+
+    /// True once a finite source has delivered all of its audio.
+    virtual bool Finished() const { return false; }
+
+    /// True if the sink runs on a device's real-time callback thread.
+    /// Only then is that thread given the audio role's priority; a
+    /// replay or ring reader is an ordinary thread that may block.
+    virtual bool RealTime() const { return false; }
+
+    /// Frames handed to the sink so far.
+    uint64_t FramesDelivered() const { return m_delivered.load(); }
+
+protected:
+    std::atomic<uint64_t> m_delivered{0};
+};
+
+/// The default miniaudio capture device, at its native rate and channel count.
+class DeviceCaptureSource : public CaptureSource {
+public:
+    ~DeviceCaptureSource() override;
+
+    bool Open() override;
+    bool Start(FrameSink sink) override;
+    void Stop() override;
+
+    uint32_t SampleRate() const override { return m_device.sampleRate; }
+    uint32_t Channels() const override   { return m_device.capture.channels; }
+    bool RealTime() const override       { return true; }
+
+private:
+    static void DataCallback(ma_device* pDevice, void* pOutput,
+                             const void* pInput, ma_uint32 frameCount);
+
+    ma_device m_device = {};
+    bool      m_init   = false;
+    FrameSink m_sink;
+};
+
+/// Replays a sound file (anything miniaudio decodes, e.g. WAV) or raw
+/// PCM from a file or pipe, paced like a capture device.
+class FileCaptureSource : public CaptureSource {
+public:
+    struct Options {
+        double   speed    = 1.0;     // 1 = real time, 4 = four times faster
+        bool     raw      = false;   // headerless PCM instead of a decodable file
+        bool     rawFloat = false;   // raw samples are f32le (default s16le)
+        uint32_t rate     = 16000;   // raw only
+        uint32_t channels = 1;       // raw only
+    };
+
+    /// @param path  File to replay; "-" reads raw PCM from stdin.
+    FileCaptureSource(std::string path, Options options);
+    ~FileCaptureSource() override;
+
+    bool Open() override;
+    bool Start(FrameSink sink) override;
+    void Stop() override;
+
+    uint32_t SampleRate() const override { return m_rate; }
+    uint32_t Channels() const override   { return m_channels; }
+    bool     Finished() const override   { return m_finished.load(); }
+
+private:
+    void   Run(FrameSink sink);
+    size_t ReadFrames(float* out, size_t frames);   // 0 at end of input or on Stop()
+    size_t ReadRaw(void* out, size_t bytes);
+
+    std::string m_path;
+    Options     m_options;
+    uint32_t    m_rate     = 0;
+    uint32_t    m_channels = 0;
+
+    ma_decoder  m_decoder     = {};
+    bool        m_decoderInit = false;
+    int         m_rawFd       = -1;         // raw input; may be stdin
+    int         m_wake[2]     = {-1, -1};   // Stop() → a reader waiting on a pipe
+    std::vector<int16_t> m_pcm16;   // raw s16 read buffer (replay thread)
+
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_stop = false;
+    std::atomic<bool>       m_finished{false};
+};
+
+/// Frames another process writes into a SharedAudioRing — the inference
+/// worker's view of the app's capture device.  A thread polls the ring
+/// and forwards whatever arrived; Stop() forwards what's left first, so
+/// nothing captured before the app sent "stop" is lost.
+class SharedRingCaptureSource : public CaptureSource {
+public:
+    /// @param from  Ring position of the session's first sample.
+    SharedRingCaptureSource(SharedAudioRing& ring, uint64_t from,
+                            uint32_t sampleRate, uint32_t channels);
+    ~SharedRingCaptureSource() override;
+
+    bool Open() override { return m_rate > 0 && m_channels > 0; }
+    bool Start(FrameSink sink) override;
+    void Stop() override;
+
+    uint32_t SampleRate() const override { return m_rate; }
+    uint32_t Channels() const override   { return m_channels; }
+
+    /// Samples the producer overwrote before they were read.
+    uint64_t Dropped() const { return m_dropped.load(); }
+
+private:
+    void Run(FrameSink sink);
+    void Forward(const FrameSink& sink, std::vector<float>& buf);
+
+    SharedAudioRing&        m_ring;
+    uint64_t                m_pos;
+    uint32_t                m_rate;
+    uint32_t                m_channels;
+
+    std::thread             m_thread;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_stop = false;
+    std::atomic<uint64_t>   m_dropped{0};
+};
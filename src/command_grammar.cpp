@@ -0,0 +1,143 @@
+#include "command_grammar.h"
+
+#include <whisper.h>
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+static constexpr const char* PUNCTUATION[] = {".", "!", "?", ","};
+
+/// Lowercase words of @p text, single-space separated, punctuation dropped.
+static std::string normalizedPhrase(const std::string& text) {
+    std::string out;
+    bool gap = false;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '\'') {
+            if (gap && !out.empty()) out += ' ';
+            out += static_cast<char>(std::tolower(c));
+            gap = false;
+        } else {
+            gap = true;
+        }
+    }
+    return out;
+}
+
+static std::vector<int32_t> tokenize(whisper_context* ctx, const std::string& text) {
+    // A token is at least one byte, so this is always large enough.
+    std::vector<int32_t> tokens(text.size() + 2);
+    int n = whisper_tokenize(ctx, text.c_str(), tokens.data(), static_cast<int>(tokens.size()));
+    tokens.resize(n > 0 ? n : 0);
+    return tokens;
+}
+
+bool CommandGrammar::Build(whisper_context* ctx, const std::vector<std::string>& phrases) {
+    m_nodes.assign(1, Node());
+    m_phrases.clear();
+    m_punctuation.clear();
+    if (!ctx) return false;
+
+    m_eot    = whisper_token_eot(ctx);
+    m_nVocab = whisper_n_vocab(ctx);
+
+    for (const auto& phrase : phrases) {
+        std::string norm = normalizedPhrase(phrase);
+        if (norm.empty()) continue;
+        int index = static_cast<int>(m_phrases.size());
+        m_phrases.push_back(norm);
+
+        // whisper starts its text with a space and usually capitalizes
+        // the first word; accept either casing so the grammar doesn't
+        // fight the model over it.
+        std::string capital = norm;
+        capital[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(capital[0])));
+        Insert(tokenize(ctx, " " + norm), index);
+        Insert(tokenize(ctx, " " + capital), index);
+    }
+
+    for (const char* p : PUNCTUATION) {
+        auto tokens = tokenize(ctx, p);
+        if (tokens.size() == 1) m_punctuation.push_back(tokens[0]);
+    }
+    return !Empty();
+}
+
+void CommandGrammar::Insert(const std::vector<int32_t>& tokens, int phrase) {
+    if (tokens.empty()) return;
+    int node = 0;
+    for (int32_t t : tokens) {
+        auto it = m_nodes[node].next.find(t);
+        if (it != m_nodes[node].next.end()) {
+            node = it->second;
+        } else {
+            int child = static_cast<int>(m_nodes.size());
+            m_nodes[node].next[t] = child;
+            m_nodes.emplace_back();
+            node = child;
+        }
+    }
+    // Two phrases that tokenize alike: the first one wins.
+    if (m_nodes[node].phrase < 0) m_nodes[node].phrase = phrase;
+}
+
+void CommandGrammar::Constrain(const whisper_token_data* tokens, int nTokens, float* logits) {
+    if (Empty() || m_nVocab <= 0) return;
+
+    // Follow what has been decoded so far.  Anything off the trie (or
+    // after closing punctuation) may only end the text.
+    int  node   = 0;
+    bool closed = false;
+    for (int i = 0; i < nTokens && node >= 0 && !closed; ++i) {
+        int32_t id = tokens[i].id;
+        auto it = m_nodes[node].next.find(id);
+        if (it != m_nodes[node].next.end())
+            node = it->second;
+        else if (m_nodes[node].phrase >= 0
+                 && std::find(m_punctuation.begin(), m_punctuation.end(), id) != m_punctuation.end())
+            closed = true;
+        else
+            node = -1;
+    }
+
+    m_allowed.clear();
+    if (node < 0 || closed) {
+        m_allowed.push_back(m_eot);
+    } else {
+        for (const auto& [token, child] : m_nodes[node].next)
+            m_allowed.push_back(token);
+        if (m_nodes[node].phrase >= 0) {
+            m_allowed.push_back(m_eot);
+            m_allowed.insert(m_allowed.end(), m_punctuation.begin(), m_punctuation.end());
+        }
+    }
+
+    // Score the step before masking: log-softmax of the best token the
+    // grammar allows, under the model's own distribution.
+    float maxLogit = -INFINITY;
+    for (int i = 0; i < m_nVocab; ++i) maxLogit = std::max(maxLogit, logits[i]);
+    float best = -INFINITY;
+    for (int32_t t : m_allowed)
+        if (t >= 0 && t < m_nVocab) best = std::max(best, logits[t]);
+    if (std::isfinite(maxLogit) && std::isfinite(best)) {
+        double sum = 0.0;
+        for (int i = 0; i < m_nVocab; ++i)
+            if (std::isfinite(logits[i])) sum += std::exp(logits[i] - maxLogit);
+        m_logProbSum += (best - maxLogit) - std::log(sum);
+        ++m_steps;
+    }
+
+    // Mask everything else.
+    m_kept.clear();
+    for (int32_t t : m_allowed)
+        m_kept.push_back(t >= 0 && t < m_nVocab ? logits[t] : -INFINITY);
+    std::fill(logits, logits + m_nVocab, -INFINITY);
+    for (size_t i = 0; i < m_allowed.size(); ++i)
+        if (m_allowed[i] >= 0 && m_allowed[i] < m_nVocab) logits[m_allowed[i]] = m_kept[i];
+}
+
+int CommandGrammar::Match(const std::string& text) const {
+    std::string norm = normalizedPhrase(text);
+    for (size_t i = 0; i < m_phrases.size(); ++i)
+        if (m_phrases[i] == norm) return static_cast<int>(i);
+    return -1;
+}
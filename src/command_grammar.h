@@ -0,0 +1,69 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+struct whisper_context;
+struct whisper_token_data;
+
+/// Constrained decoding against a small vocabulary of spoken commands.
+///
+/// Build() tokenizes every phrase the ways whisper tends to write it
+/// (" yes", " Yes") into a token trie.  Constrain() runs from whisper's
+/// logits filter and masks every token that would leave the trie, so the
+/// greedy decoder can only spell out one of the phrases, optionally
+/// followed by punctuation, and must then end — a decode takes a handful
+/// of steps at most.  Each step is also scored against the unconstrained
+/// distribution, so speech that isn't a command can be rejected.
+class CommandGrammar {
+public:
+    /// MeanLogProb() below this: the grammar forced the phrase onto
+    /// speech that wasn't a command.
+    static constexpr double MIN_MEAN_LOGPROB = -1.5;
+
+    /// Tokenize @p phrases with @p ctx's vocabulary.  Returns false if
+    /// none of them produced any tokens.
+    bool Build(whisper_context* ctx, const std::vector<std::string>& phrases);
+
+    bool Empty() const { return m_nodes.size() <= 1; }
+
+    /// Forget the score of the previous decode.
+    void BeginDecode() { m_logProbSum = 0.0; m_steps = 0; }
+
+    /// whisper logits filter: @p tokens are the ones decoded so far,
+    /// @p logits the scores for the next one (n_vocab entries).
+    void Constrain(const whisper_token_data* tokens, int nTokens, float* logits);
+
+    /// Mean log-probability the unconstrained model gave the tokens the
+    /// grammar let through, over the last decode.  Near 0 when whisper
+    /// would have written the command anyway; very negative when the
+    /// grammar had to force it.
+    double MeanLogProb() const { return m_steps ? m_logProbSum / m_steps : -1e9; }
+
+    /// True if the model found the last decode plausible on its own.
+    bool Plausible() const { return MeanLogProb() >= MIN_MEAN_LOGPROB; }
+
+    /// Index of the phrase @p text spells (ignoring case and
+    /// punctuation), or -1.
+    int Match(const std::string& text) const;
+
+private:
+    struct Node {
+        std::map<int32_t, int> next;   // token → child node
+        int                    phrase = -1;   // phrase ending here, or -1
+    };
+
+    void Insert(const std::vector<int32_t>& tokens, int phrase);
+
+    std::vector<Node>        m_nodes;        // [0] is the root
+    std::vector<std::string> m_phrases;      // normalized, for Match()
+    std::vector<int32_t>     m_punctuation;  // allowed after a complete phrase
+    std::vector<int32_t>     m_allowed;      // Constrain() scratch
+    std::vector<float>       m_kept;         // ... and their logits
+    int32_t                  m_eot    = 0;
+    int                      m_nVocab = 0;
+    double                   m_logProbSum = 0.0;
+    int                      m_steps      = 0;
+};
@@ -0,0 +1,125 @@
+// Checks CommandGrammar's token trie and its rejection threshold.
+//
+// The phrases are tokenized with the real vocabulary of the model at
+// WHISPER_MODEL_PATH (or argv[1]); without a downloaded model the test
+// is reported as skipped.  Constrain() is driven with made-up logits,
+// standing in for the decoder: at each step only the trie's next tokens
+// (and, after a whole phrase, punctuation or the end) may survive, and
+// the score must separate a phrase the model would have written anyway
+// from one the grammar had to force.
+//
+//   whisper-agent-grammar-test [model.bin]
+
+#include "command_grammar.h"
+
+#include <whisper.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static constexpr float LIKELY_LOGIT = 15.0f;   // the token the model prefers
+static constexpr float FORCED_LOGIT = 20.0f;   // a token the grammar masks
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+static std::vector<whisper_token_data> tokens(whisper_context* ctx, const std::string& text) {
+    std::vector<whisper_token> ids(text.size() + 2);
+    int n = whisper_tokenize(ctx, text.c_str(), ids.data(), static_cast<int>(ids.size()));
+    std::vector<whisper_token_data> out(std::max(n, 0));
+    for (int i = 0; i < n; ++i) out[i].id = ids[i];
+    return out;
+}
+
+/// Tokens left unmasked after Constrain() with @p decoded so far.
+static std::vector<int> allowedAfter(CommandGrammar& grammar, int nVocab,
+                                     const std::vector<whisper_token_data>& decoded)
+{
+    std::vector<float> logits(nVocab, 0.0f);
+    grammar.Constrain(decoded.data(), static_cast<int>(decoded.size()), logits.data());
+    std::vector<int> allowed;
+    for (int i = 0; i < nVocab; ++i)
+        if (std::isfinite(logits[i])) allowed.push_back(i);
+    return allowed;
+}
+
+static bool contains(const std::vector<int>& v, int token) {
+    return std::find(v.begin(), v.end(), token) != v.end();
+}
+
+int main(int argc, char** argv) {
+    const std::string modelPath = argc > 1 ? argv[1] : WHISPER_MODEL_PATH;
+    if (!std::ifstream(modelPath)) {
+        std::printf("skip command grammar: no model at %s\n", modelPath.c_str());
+        return 0;
+    }
+    whisper_context_params params = whisper_context_default_params();
+    params.use_gpu = false;
+    whisper_context* ctx = whisper_init_from_file_with_params(modelPath.c_str(), params);
+    if (!ctx) {
+        std::printf("FAIL cannot load %s\n", modelPath.c_str());
+        return 1;
+    }
+    const int nVocab = whisper_n_vocab(ctx);
+    const int eot    = whisper_token_eot(ctx);
+
+    CommandGrammar grammar;
+    check(grammar.Build(ctx, {"yes", "no", "open file"}), "grammar builds");
+
+    // The first step may only start a phrase, in either casing.
+    auto first = allowedAfter(grammar, nVocab, {});
+    bool starts = contains(first, tokens(ctx, " yes")[0].id)
+               && contains(first, tokens(ctx, " Yes")[0].id)
+               && contains(first, tokens(ctx, " open")[0].id);
+    check(starts && !contains(first, eot) && first.size() <= 6,
+          "first step: only phrase starts");
+
+    // Halfway through a phrase, only its continuation.
+    auto open = tokens(ctx, " open file");
+    std::vector<whisper_token_data> half(open.begin(), open.end() - 1);
+    auto next = allowedAfter(grammar, nVocab, half);
+    check(next.size() == 1 && next[0] == open.back().id, "mid-phrase: only the next token");
+
+    // After a whole phrase: the end or closing punctuation.
+    auto done = allowedAfter(grammar, nVocab, open);
+    check(contains(done, eot) && contains(done, tokens(ctx, ".")[0].id)
+          && !contains(done, open[0].id), "whole phrase: end or punctuation");
+
+    auto closed = open;
+    closed.push_back(tokens(ctx, ".")[0]);
+    auto afterDot = allowedAfter(grammar, nVocab, closed);
+    check(afterDot.size() == 1 && afterDot[0] == eot, "after punctuation: only the end");
+
+    auto offTrie = allowedAfter(grammar, nVocab, tokens(ctx, " maybe"));
+    check(offTrie.size() == 1 && offTrie[0] == eot, "off the trie: only the end");
+
+    // Rejection: the model already favours the phrase's tokens, versus
+    // preferring something the grammar masks at every step.
+    auto score = [&](bool forced) {
+        grammar.BeginDecode();
+        std::vector<whisper_token_data> decoded;
+        for (const auto& t : tokens(ctx, " yes")) {
+            std::vector<float> logits(nVocab, 0.0f);
+            logits[t.id] = forced ? 0.0f : LIKELY_LOGIT;
+            if (forced) logits[tokens(ctx, " maybe")[0].id] = FORCED_LOGIT;
+            grammar.Constrain(decoded.data(), static_cast<int>(decoded.size()), logits.data());
+            decoded.push_back(t);
+        }
+        return grammar.Plausible();
+    };
+    check(score(/*forced=*/false), "a phrase the model would write is accepted");
+    check(!score(/*forced=*/true), "a phrase the grammar forced is rejected");
+
+    check(grammar.Match("Open file.") == 2 && grammar.Match("open files") < 0,
+          "Match ignores case and punctuation only");
+
+    whisper_free(ctx);
+    return failures ? 1 : 0;
+}
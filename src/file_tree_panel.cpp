@@ -7,6 +7,7 @@
 #include <vector>
 
 wxDEFINE_EVENT(EVT_FILE_SELECTED, wxCommandEvent);
+wxDEFINE_EVENT(EVT_TREE_CHANGED, wxCommandEvent);
 
 static bool IsHiddenDir(const wxString& name) {
     return name == "." || name == "..";
@@ -166,7 +167,16 @@ void FileTreePanel::OnFileSystemEvent(wxFileSystemWatcherEvent& evt) {
     if (type == wxFSW_EVENT_ACCESS)
         return;
 
-    // Handles CREATE, DELETE, RENAME, MODIFY and WARNING/ERROR
+    // Handles CREATE, DELETE, RENAME, MODIFY and WARNING/ERROR.  A
+    // warning or error may mean lost events: treat the whole tree as
+    // changed.
+    if (type == wxFSW_EVENT_WARNING || type == wxFSW_EVENT_ERROR) {
+        m_changedPaths.insert(m_rootDir);
+    } else {
+        m_changedPaths.insert(evt.GetPath().GetFullPath());
+        if (type == wxFSW_EVENT_RENAME)
+            m_changedPaths.insert(evt.GetNewPath().GetFullPath());
+    }
     m_refreshTimer.StartOnce(200);
 }
 
@@ -174,12 +184,24 @@ void FileTreePanel::OnRefreshTimer(wxTimerEvent&) {
     auto expanded = GetExpandedPaths();
     SetRootDir(m_rootDir);
     RestoreExpandedPaths(expanded);
+
+    auto changed = std::move(m_changedPaths);
+    m_changedPaths.clear();
+    for (const auto& path : changed)
+        NotifyChanged(path);
 }
 
 void FileTreePanel::OnRefreshClicked(wxCommandEvent&) {
     auto expanded = GetExpandedPaths();
     SetRootDir(m_rootDir);
     RestoreExpandedPaths(expanded);
+    NotifyChanged(m_rootDir);
+}
+
+void FileTreePanel::NotifyChanged(const wxString& path) {
+    wxCommandEvent evt(EVT_TREE_CHANGED);
+    evt.SetString(path);
+    wxPostEvent(wxGetTopLevelParent(this), evt);
 }
 
 std::vector<wxString> FileTreePanel::GetExpandedPaths() {
@@ -3,16 +3,20 @@
 #include <wx/wx.h>
 #include <wx/treectrl.h>
 #include <wx/fswatcher.h>
+#include <set>
 #include <vector>
 
 // Custom event: fired when user double-clicks a file
 wxDECLARE_EVENT(EVT_FILE_SELECTED, wxCommandEvent);
+// Custom event: files changed on disk below the path in GetString()
+wxDECLARE_EVENT(EVT_TREE_CHANGED, wxCommandEvent);
 
 class FileTreePanel : public wxPanel {
 public:
     FileTreePanel(wxWindow* parent, const wxString& rootDir);
     ~FileTreePanel();
     void SetRootDir(const wxString& dir);
+    const wxString& GetRootDir() const { return m_rootDir; }
 
 private:
     void PopulateChildren(const wxTreeItemId& parent, const wxString& path);
@@ -28,11 +32,13 @@ private:
     void OnRefreshClicked(wxCommandEvent& evt);
     std::vector<wxString> GetExpandedPaths();
     void RestoreExpandedPaths(const std::vector<wxString>& paths);
+    void NotifyChanged(const wxString& path);
 
     wxTreeCtrl*            m_tree = nullptr;
     wxString               m_rootDir;
     wxFileSystemWatcher*   m_watcher = nullptr;
     wxTimer                m_refreshTimer;
+    std::set<wxString>     m_changedPaths;    // since the last refresh
 
     // Per-item data stored via wxTreeItemData
     struct ItemData : public wxTreeItemData {
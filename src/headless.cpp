@@ -0,0 +1,452 @@
+// Headless streaming dictation.
+//
+// Runs the same Transcriber the window does — streaming partials,
+// commits, final pass — and reports each update as one JSON line:
+//
+//   {"type":"model","state":"ready"}
+//   {"type":"partial","text":"run the"}
+//   {"type":"final","text":"Run the tests."}
+//
+// "text" is always the whole utterance so far.  With --agent the
+// command runs on a PTY instead: its output is copied to stdout and
+// every final is typed into it, followed by Enter.
+//
+// A file or stdin is one utterance, ending with the input.  From the
+// capture device, each line read on stdin ends the current utterance
+// and starts the next; EOF, SIGINT or SIGTERM ends the last one.
+//
+//   whisper-agent --headless [--input PATH | -] [--raw] [--f32]
+//                 [--rate N] [--channels N] [--speed X]
+//                 [--model PATH] [--final-model PATH | --no-final]
+//                 [--threads N] [--int16] [--no-agc] [--full-context]
+//                 [--agent COMMAND] [--cwd DIR] [--project DIR]
+
+#include "headless.h"
+#include "project_vocabulary.h"
+#include "thread_placement.h"
+#include "transcriber.h"
+
+#include <fcntl.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static constexpr int POLL_MS              = 20;
+static constexpr int AGENT_ENTER_DELAY_MS = 150;     // text first, Enter after — as the GUI does
+static constexpr int FINAL_TIMEOUT_MS     = 30000;   // give up on a final pass after this
+
+static std::atomic<bool> s_interrupted{false};
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static std::string jsonString(const std::string& text) {
+    std::string out = "\"";
+    for (unsigned char c : text) {
+        switch (c) {
+        case '"':  out += "\\\""; break;
+        case '\\': out += "\\\\"; break;
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\t': out += "\\t";  break;
+        default:
+            if (c < 0x20) {
+                char buf[8];
+                std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                out += buf;
+            } else {
+                out += static_cast<char>(c);
+            }
+        }
+    }
+    return out + "\"";
+}
+
+static const char* modelStateName(Transcriber::ModelState state) {
+    switch (state) {
+    case Transcriber::ModelState::Loading:     return "loading";
+    case Transcriber::ModelState::Calibrating: return "calibrating";
+    case Transcriber::ModelState::Ready:       return "ready";
+    case Transcriber::ModelState::Failed:      return "failed";
+    }
+    return "unknown";
+}
+
+static void writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return;
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s --headless [--input PATH | -] [--raw] [--f32] [--rate N]\n"
+        "          [--channels N] [--speed X] [--model PATH]\n"
+        "          [--final-model PATH | --no-final] [--threads N] [--int16]\n"
+        "          [--no-agc] [--full-context] [--agent COMMAND] [--cwd DIR]\n"
+        "          [--project DIR]\n"
+        "\n"
+        "Without --input, records from the default capture device; each line\n"
+        "on stdin ends an utterance, EOF or Ctrl+C ends the last one.\n"
+        "--input - reads raw PCM (s16le, or f32le with --f32) from stdin.\n"
+        "Transcripts are printed as JSON lines, or with --agent typed into\n"
+        "COMMAND running on a PTY, whose output goes to stdout.\n"
+        "--project biases recognition toward DIR's file names and identifiers\n"
+        "(default: the --cwd folder, if any).\n",
+        argv0);
+}
+
+// ============================================================================
+// Agent on a PTY
+// ============================================================================
+
+/// The agent command on a pseudo-terminal, as the GUI's terminal panel
+/// runs it.  Its output is passed through to stdout.
+class HeadlessAgent {
+public:
+    ~HeadlessAgent() {
+        if (m_pid > 0) kill(m_pid, SIGHUP);
+        if (m_masterFd >= 0) close(m_masterFd);
+    }
+
+    bool Spawn(const std::string& command, const std::string& workingDir) {
+        struct winsize ws = {};
+        ws.ws_row = 50;
+        ws.ws_col = 120;
+        m_pid = forkpty(&m_masterFd, nullptr, nullptr, &ws);
+        if (m_pid < 0) {
+            std::fprintf(stderr, "forkpty failed: %s\n", std::strerror(errno));
+            return false;
+        }
+        if (m_pid == 0) {
+            if (!workingDir.empty() && chdir(workingDir.c_str()) != 0)
+                _exit(127);
+            setenv("TERM",      "xterm-256color", 1);
+            setenv("COLORTERM", "truecolor",      1);
+            execlp("/bin/sh", "sh", "-c", command.c_str(), nullptr);
+            _exit(127);
+        }
+        fcntl(m_masterFd, F_SETFL, fcntl(m_masterFd, F_GETFL) | O_NONBLOCK);
+        return true;
+    }
+
+    bool Alive() const { return m_masterFd >= 0; }
+
+    /// Copy pending output to stdout; sends a queued Enter when it's due.
+    void Pump() {
+        if (m_enterAt != Clock::time_point() && Clock::now() >= m_enterAt) {
+            m_enterAt = Clock::time_point();
+            Write("\r");
+        }
+        char buf[4096];
+        while (m_masterFd >= 0) {
+            ssize_t n = ::read(m_masterFd, buf, sizeof(buf));
+            if (n > 0) {
+                writeAll(STDOUT_FILENO, buf, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) break;
+            // The agent exited (EIO once the slave side is closed).
+            close(m_masterFd);
+            m_masterFd = -1;
+            waitpid(m_pid, nullptr, 0);
+            m_pid = -1;
+        }
+    }
+
+    /// Type @p text, then Enter a moment later so the agent takes the
+    /// text in before the keypress.
+    void Send(const std::string& text) {
+        if (text.empty()) return;
+        Write(text);
+        m_enterAt = Clock::now() + std::chrono::milliseconds(AGENT_ENTER_DELAY_MS);
+    }
+
+private:
+    void Write(const std::string& data) {
+        if (m_masterFd < 0) return;
+        const char* p    = data.data();
+        size_t      left = data.size();
+        while (left > 0) {
+            ssize_t n = ::write(m_masterFd, p, left);
+            if (n < 0 && (errno == EAGAIN || errno == EINTR)) {
+                pollfd pfd = {m_masterFd, POLLOUT, 0};
+                poll(&pfd, 1, POLL_MS);
+                continue;
+            }
+            if (n <= 0) return;
+            p    += n;
+            left -= static_cast<size_t>(n);
+        }
+    }
+
+    pid_t             m_pid      = -1;
+    int               m_masterFd = -1;
+    Clock::time_point m_enterAt;
+};
+
+// ============================================================================
+// Stdin control (capture device input)
+// ============================================================================
+
+/// Non-blocking line reader: Poll() reports whether a line (or EOF)
+/// arrived since the last call.
+class StdinLines {
+public:
+    enum Event { None, Line, Eof };
+
+    Event Poll() {
+        if (m_eof) return Eof;
+        pollfd pfd = {STDIN_FILENO, POLLIN, 0};
+        while (poll(&pfd, 1, 0) > 0) {
+            char buf[256];
+            ssize_t n = ::read(STDIN_FILENO, buf, sizeof(buf));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                m_eof = true;
+                return Eof;
+            }
+            if (std::memchr(buf, '\n', static_cast<size_t>(n)))
+                return Line;
+        }
+        return None;
+    }
+
+private:
+    bool m_eof = false;
+};
+
+// ============================================================================
+// Session
+// ============================================================================
+
+struct HeadlessOptions {
+    std::string                input;          // empty = capture device
+    FileCaptureSource::Options replay;
+    std::string                model      = WHISPER_MODEL_PATH;
+    std::string                finalModel = WHISPER_FINAL_MODEL_PATH;
+    int                        threads    = 0;
+    bool                       compact    = false;
+    bool                       autoGain   = true;
+    bool                       adaptive   = true;
+    std::string                agent;          // empty = JSON on stdout
+    std::string                workingDir;
+    std::string                project;        // glossary source; empty = workingDir
+};
+
+/// Transcriber callbacks → JSON on stdout, or finals for the agent.
+class HeadlessSink {
+public:
+    explicit HeadlessSink(bool json) : m_json(json) {}
+
+    void Model(Transcriber::ModelState state) {
+        if (state == Transcriber::ModelState::Failed) m_failed = true;
+        if (m_json)
+            Emit(std::string("{\"type\":\"model\",\"state\":\"") + modelStateName(state) + "\"}");
+        else if (state == Transcriber::ModelState::Failed)
+            std::fprintf(stderr, "whisper-agent: model failed to load\n");
+    }
+
+    void Text(const std::string& text, bool isFinal) {
+        {
+            std::lock_guard<std::mutex> lk(m_mutex);
+            m_last = text;
+            if (isFinal) {
+                m_gotFinal = true;
+                m_cv.notify_all();
+            }
+        }
+        if (m_json)
+            Emit(std::string("{\"type\":\"") + (isFinal ? "final" : "partial")
+                 + "\",\"text\":" + jsonString(text) + "}");
+    }
+
+    void BeginUtterance() {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_gotFinal = false;
+        m_last.clear();
+    }
+
+    /// The final text of the utterance just stopped.  If @p pending,
+    /// waits for the final pass (pumping the agent meanwhile); if that
+    /// won't come, the last partial is reported as final.
+    std::string Finish(bool pending, HeadlessAgent* agent) {
+        auto giveUp = Clock::now() + std::chrono::milliseconds(FINAL_TIMEOUT_MS);
+        std::unique_lock<std::mutex> lk(m_mutex);
+        while (pending && !m_gotFinal && Clock::now() < giveUp) {
+            m_cv.wait_for(lk, std::chrono::milliseconds(POLL_MS));
+            if (agent) {
+                lk.unlock();
+                agent->Pump();
+                lk.lock();
+            }
+        }
+        std::string text = m_last;
+        bool        got  = m_gotFinal;
+        lk.unlock();
+        if (!got)
+            Text(text, /*isFinal=*/true);
+        return text;
+    }
+
+    bool Failed() const { return m_failed.load(); }
+
+private:
+    void Emit(const std::string& line) {
+        std::lock_guard<std::mutex> lk(m_outMutex);
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }
+
+    const bool              m_json;
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+    bool                    m_gotFinal = false;
+    std::string             m_last;
+    std::mutex              m_outMutex;
+    std::atomic<bool>       m_failed{false};
+};
+
+// ============================================================================
+// Entry point
+// ============================================================================
+
+int RunHeadless(int argc, char** argv) {
+    const char*     argv0 = "whisper-agent";
+    HeadlessOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(argv0); std::exit(2); }
+            return argv[++i];
+        };
+        if      (arg == "--input")        opt.input             = next();
+        else if (arg == "--raw")          opt.replay.raw        = true;
+        else if (arg == "--f32")          opt.replay.rawFloat   = true;
+        else if (arg == "--rate")         opt.replay.rate       = static_cast<uint32_t>(std::atoi(next()));
+        else if (arg == "--channels")     opt.replay.channels   = static_cast<uint32_t>(std::atoi(next()));
+        else if (arg == "--speed")        opt.replay.speed      = std::atof(next());
+        else if (arg == "--model")        opt.model             = next();
+        else if (arg == "--final-model")  opt.finalModel        = next();
+        else if (arg == "--no-final")     opt.finalModel.clear();
+        else if (arg == "--threads")      opt.threads           = std::atoi(next());
+        else if (arg == "--int16")        opt.compact           = true;
+        else if (arg == "--no-agc")       opt.autoGain          = false;
+        else if (arg == "--full-context") opt.adaptive          = false;
+        else if (arg == "--agent")        opt.agent             = next();
+        else if (arg == "--cwd")          opt.workingDir        = next();
+        else if (arg == "--project")      opt.project           = next();
+        else { usage(argv0); return 2; }
+    }
+    if (opt.input == "-") opt.replay.raw = true;   // stdin can only be raw PCM
+    const bool fromDevice = opt.input.empty();
+
+    // A pipeline stops us with a signal: finish the utterance first.
+    struct sigaction sa = {};
+    sa.sa_handler = [](int) { s_interrupted = true; };
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT,  &sa, nullptr);
+    sigaction(SIGTERM, &sa, nullptr);
+    signal(SIGPIPE, SIG_IGN);
+
+    // Same thread layout as the app, minus the UI.
+    ThreadPlacement placement;
+    placement.Configure(ThreadPlacement::Policy{});
+
+    HeadlessAgent agent;
+    if (!opt.agent.empty() && !agent.Spawn(opt.agent, opt.workingDir))
+        return 1;
+    HeadlessAgent* agentPtr = opt.agent.empty() ? nullptr : &agent;
+
+    HeadlessSink sink(/*json=*/agentPtr == nullptr);
+    Transcriber  tr;
+    tr.SetThreadPlacement(&placement);
+    tr.SetThreadCount(opt.threads);
+    tr.SetCompactAudio(opt.compact);
+    tr.SetAutoGain(opt.autoGain);
+    tr.SetAdaptiveContext(opt.adaptive);
+    tr.SetModelCallback([&](Transcriber::ModelState state, int) { sink.Model(state); });
+    tr.SetCallback([&](const std::string& text, bool isFinal) { sink.Text(text, isFinal); });
+    if (!tr.Init(opt.model, opt.finalModel)) {
+        std::fprintf(stderr, "cannot open model %s\n", opt.model.c_str());
+        return 1;
+    }
+
+    // Declared after tr: its listener must stop first.
+    ProjectVocabulary vocabulary;
+    const std::string& project = opt.project.empty() ? opt.workingDir : opt.project;
+    if (!project.empty()) {
+        vocabulary.SetListener([&](const std::vector<std::string>& terms) { tr.SetGlossary(terms); });
+        vocabulary.SetRoot(project);
+    }
+
+    // Utterances until the input (or the user) says stop.  Audio is
+    // captured while the model is still loading.
+    StdinLines control;
+    bool       more = true;
+    while (more && !s_interrupted && !sink.Failed()) {
+        std::unique_ptr<CaptureSource> source;
+        if (fromDevice) source = std::make_unique<DeviceCaptureSource>();
+        else            source = std::make_unique<FileCaptureSource>(opt.input, opt.replay);
+
+        sink.BeginUtterance();
+        if (!tr.StartRecording(std::move(source))) {
+            if (tr.LoadFailed())
+                std::fprintf(stderr, "cannot load model %s\n", opt.model.c_str());
+            else
+                std::fprintf(stderr, "cannot open %s\n",
+                             fromDevice ? "the capture device" : opt.input.c_str());
+            return 1;
+        }
+
+        more = false;
+        for (;;) {
+            if (agentPtr) agent.Pump();
+            if (s_interrupted || sink.Failed()) break;
+            if (fromDevice) {
+                auto event = control.Poll();
+                if (event == StdinLines::Line) { more = true; break; }
+                if (event == StdinLines::Eof) break;
+            } else if (tr.CaptureFinished()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+        }
+
+        std::string text = sink.Finish(tr.StopRecording(), agentPtr);
+        if (agentPtr)
+            agent.Send(text);
+    }
+
+    // The agent outlives the dictation: keep passing its output through
+    // until it exits or we're told to stop.
+    while (agentPtr && agent.Alive() && !s_interrupted) {
+        agent.Pump();
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+    }
+
+    tr.SetCallback(nullptr);
+    tr.SetModelCallback(nullptr);
+    return sink.Failed() ? 1 : 0;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+/// `whisper-agent --headless ...`: the streaming dictation engine with no
+/// windows, for machines without a display.  Audio comes from the
+/// capture device, a sound file or raw PCM on stdin; transcripts go to
+/// stdout as JSON lines, or into an agent running on a PTY.  Never
+/// touches wxWidgets.  @p argc / @p argv start at "--headless".
+int RunHeadless(int argc, char** argv);
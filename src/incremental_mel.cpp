@@ -0,0 +1,203 @@
+#include "incremental_mel.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr int    SAMPLE_RATE  = 16000;
+static constexpr int    N_BINS       = IncrementalMel::N_FFT / 2 + 1;
+static constexpr int    HALF_FRAME   = IncrementalMel::N_FFT / 2;
+static constexpr int    HEAD_FRAMES  = (HALF_FRAME + IncrementalMel::HOP - 1) / IncrementalMel::HOP;  // reach before the window start
+static constexpr int    EDGE_FRAMES  = IncrementalMel::N_FFT / IncrementalMel::HOP + 1;  // most frames straddling the end
+static constexpr float  SILENCE_LOG  = -10.0f;   // log10 of whisper's 1e-10 floor
+
+// Slaney mel scale, as used by librosa (and therefore by whisper's filters).
+static double hzToMel(double hz) {
+    const double fSp = 200.0 / 3.0, minLogHz = 1000.0, minLogMel = minLogHz / fSp;
+    const double logStep = std::log(6.4) / 27.0;
+    return hz < minLogHz ? hz / fSp : minLogMel + std::log(hz / minLogHz) / logStep;
+}
+
+static double melToHz(double mel) {
+    const double fSp = 200.0 / 3.0, minLogHz = 1000.0, minLogMel = minLogHz / fSp;
+    const double logStep = std::log(6.4) / 27.0;
+    return mel < minLogMel ? mel * fSp : minLogHz * std::exp(logStep * (mel - minLogMel));
+}
+
+IncrementalMel::IncrementalMel(int nMel)
+    : m_nMel(nMel)
+    , m_hann(N_FFT)
+    , m_cos(static_cast<size_t>(N_BINS) * N_FFT)
+    , m_sin(static_cast<size_t>(N_BINS) * N_FFT)
+    , m_filters(static_cast<size_t>(nMel) * N_BINS, 0.0f)
+{
+    // Periodic Hann window, like whisper.
+    for (int i = 0; i < N_FFT; ++i)
+        m_hann[i] = static_cast<float>(0.5 * (1.0 - std::cos(2.0 * M_PI * i / N_FFT)));
+
+    // Only the non-negative half of the spectrum is needed for real
+    // input, so a direct DFT over 201 bins is cheap enough per frame.
+    for (int k = 0; k < N_BINS; ++k)
+        for (int n = 0; n < N_FFT; ++n) {
+            double a = 2.0 * M_PI * k * n / N_FFT;
+            m_cos[static_cast<size_t>(k) * N_FFT + n] = static_cast<float>(std::cos(a));
+            m_sin[static_cast<size_t>(k) * N_FFT + n] = static_cast<float>(std::sin(a));
+        }
+
+    // librosa.filters.mel(sr=16000, n_fft=400, n_mels=nMel), Slaney-normalized.
+    std::vector<double> melHz(nMel + 2);
+    double melMax = hzToMel(SAMPLE_RATE / 2.0);
+    for (int i = 0; i < nMel + 2; ++i)
+        melHz[i] = melToHz(melMax * i / (nMel + 1));
+    for (int m = 0; m < nMel; ++m) {
+        double enorm = 2.0 / (melHz[m + 2] - melHz[m]);
+        for (int k = 0; k < N_BINS; ++k) {
+            double f     = static_cast<double>(k) * SAMPLE_RATE / N_FFT;
+            double lower = (f - melHz[m]) / (melHz[m + 1] - melHz[m]);
+            double upper = (melHz[m + 2] - f) / (melHz[m + 2] - melHz[m + 1]);
+            double w     = std::max(0.0, std::min(lower, upper));
+            m_filters[static_cast<size_t>(m) * N_BINS + k] = static_cast<float>(w * enorm);
+        }
+    }
+
+    m_head.reserve(static_cast<size_t>(HEAD_FRAMES) * nMel);
+    m_tail.reserve(static_cast<size_t>(EDGE_FRAMES) * nMel);
+}
+
+void IncrementalMel::Reset() {
+    m_total       = 0;
+    m_windowStart = 0;
+    m_histBase    = 0;
+    m_hist.clear();
+    m_firstFrame  = 0;
+    m_nextFrame   = 0;
+    m_frames.clear();
+}
+
+void IncrementalMel::Append(const float* samples, size_t count) {
+    m_hist.insert(m_hist.end(), samples, samples + count);
+    m_total += static_cast<int64_t>(count);
+
+    // Frame f is centered on sample f*HOP; it's stable once every
+    // sample it covers has arrived.
+    while (m_nextFrame * HOP + HALF_FRAME <= m_total) {
+        size_t at = m_frames.size();
+        m_frames.resize(at + m_nMel);
+        ComputeFrame(m_nextFrame, m_frames.data() + at);
+        ++m_nextFrame;
+    }
+
+    TrimHistory();
+}
+
+void IncrementalMel::TrimHistory() {
+    // Later frames need the samples they cover; a later DropFront() can
+    // put the window start (and its reflected padding) anywhere inside
+    // the current window.
+    int64_t keepFrom = std::min(m_nextFrame * HOP - HALF_FRAME, m_windowStart);
+    if (keepFrom > m_histBase) {
+        size_t drop = static_cast<size_t>(std::min<int64_t>(keepFrom - m_histBase,
+                                                            static_cast<int64_t>(m_hist.size())));
+        m_hist.erase(m_hist.begin(), m_hist.begin() + drop);
+        m_histBase += static_cast<int64_t>(drop);
+    }
+}
+
+void IncrementalMel::DropFront(size_t samples) {
+    m_windowStart = std::min(m_windowStart + static_cast<int64_t>(samples), m_total);
+
+    int64_t first = m_windowStart / HOP;
+    if (first > m_firstFrame) {
+        int64_t drop = std::min(first, m_nextFrame) - m_firstFrame;
+        m_frames.erase(m_frames.begin(), m_frames.begin() + drop * m_nMel);
+        m_firstFrame += drop;
+    }
+    TrimHistory();
+}
+
+void IncrementalMel::ComputeFrame(int64_t frame, float* out) const {
+    float in[N_FFT];
+    int64_t start = frame * HOP - HALF_FRAME;
+    for (int j = 0; j < N_FFT; ++j) {
+        int64_t idx = start + j;
+        if (idx < m_windowStart)
+            idx = 2 * m_windowStart - idx;      // reflect, without repeating the edge
+        float v = (idx < m_histBase || idx >= m_total) ? 0.0f
+                : m_hist[static_cast<size_t>(idx - m_histBase)];
+        in[j] = v * m_hann[j];
+    }
+
+    // Power spectrum.  whisper folds the mirrored half of the full FFT
+    // onto the first half, which doubles every bin but DC and Nyquist.
+    float power[N_BINS];
+    for (int k = 0; k < N_BINS; ++k) {
+        const float* c = &m_cos[static_cast<size_t>(k) * N_FFT];
+        const float* s = &m_sin[static_cast<size_t>(k) * N_FFT];
+        float re = 0.0f, im = 0.0f;
+        for (int n = 0; n < N_FFT; ++n) {
+            re += in[n] * c[n];
+            im -= in[n] * s[n];
+        }
+        float p = re * re + im * im;
+        power[k] = (k == 0 || k == N_BINS - 1) ? p : 2.0f * p;
+    }
+
+    for (int m = 0; m < m_nMel; ++m) {
+        const float* w = &m_filters[static_cast<size_t>(m) * N_BINS];
+        double sum = 0.0;
+        for (int k = 0; k < N_BINS; ++k)
+            sum += static_cast<double>(power[k]) * w[k];
+        out[m] = static_cast<float>(std::log10(std::max(sum, 1e-10)));
+    }
+}
+
+int IncrementalMel::Snapshot(std::vector<float>& out) const {
+    // Same frame count whisper's own pcm_to_mel produces for this much
+    // audio: the window plus 30 s of zero padding, last frame dropped.
+    const int64_t n      = m_total - m_windowStart;
+    const int64_t first  = m_windowStart / HOP;
+    const int     nLen   = static_cast<int>((n + SAMPLE_RATE * 30) / HOP);
+    const int     stable = static_cast<int>(std::max<int64_t>(0, m_nextFrame - first));
+
+    out.resize(static_cast<size_t>(m_nMel) * nLen);
+
+    // The cached frames reaching before the window start saw the audio
+    // that was there (or zeros); redo them with the reflected padding.
+    const int headFrames = std::min(HEAD_FRAMES, stable);
+    m_head.resize(static_cast<size_t>(headFrames) * m_nMel);
+    for (int i = 0; i < headFrames; ++i)
+        ComputeFrame(first + i, m_head.data() + static_cast<size_t>(i) * m_nMel);
+
+    // Frames past the end of the audio see only zeros — except the few
+    // straddling the end, which are computed here (zero-filled) and not
+    // cached, since more audio will change them.
+    int tailFrames = 0;
+    for (int64_t f = first + stable; f * HOP - HALF_FRAME < m_total && f - first < nLen; ++f)
+        ++tailFrames;
+    m_tail.resize(static_cast<size_t>(tailFrames) * m_nMel);
+    for (int i = 0; i < tailFrames; ++i)
+        ComputeFrame(first + stable + i, m_tail.data() + static_cast<size_t>(i) * m_nMel);
+
+    auto raw = [&](int i, int m) -> float {
+        if (i < headFrames)
+            return m_head[static_cast<size_t>(i) * m_nMel + m];
+        if (i < stable)
+            return m_frames[static_cast<size_t>(first - m_firstFrame + i) * m_nMel + m];
+        if (i < stable + tailFrames)
+            return m_tail[static_cast<size_t>(i - stable) * m_nMel + m];
+        return SILENCE_LOG;
+    };
+
+    float mmax = SILENCE_LOG;
+    for (int i = 0; i < stable + tailFrames && i < nLen; ++i)
+        for (int m = 0; m < m_nMel; ++m)
+            mmax = std::max(mmax, raw(i, m));
+
+    // whisper: clamp to (max - 8), then scale to roughly [-1, 1].
+    const float floorV = mmax - 8.0f;
+    for (int m = 0; m < m_nMel; ++m) {
+        float* row = out.data() + static_cast<size_t>(m) * nLen;
+        for (int i = 0; i < nLen; ++i)
+            row[i] = (std::max(raw(i, m), floorV) + 4.0f) / 4.0f;
+    }
+    return nLen;
+}
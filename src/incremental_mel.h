@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/// Log-mel spectrogram that is extended frame by frame as audio arrives.
+///
+/// Computes the same features whisper's pcm_to_mel does: a 400-point
+/// Hann-windowed FFT every 160 samples and Slaney mel filters up to
+/// 8 kHz, stored as raw log10 energies.  Each frame is computed once,
+/// as soon as all of its samples are in, instead of on every pass.
+/// Snapshot() applies whisper's clamp/normalize step, appends 30 s of
+/// silence padding, and produces the layout whisper_set_mel() expects,
+/// frame for frame what pcm_to_mel would give for the window's samples
+/// (including the reflective padding at its start).
+class IncrementalMel {
+public:
+    static constexpr int N_FFT = 400;
+    static constexpr int HOP   = 160;
+
+    explicit IncrementalMel(int nMel = 80);
+
+    int NumMels() const { return m_nMel; }
+
+    /// The [n_mel][N_FFT/2+1] filter bank.
+    const std::vector<float>& Filters() const { return m_filters; }
+
+    /// Forget all audio (new session).
+    void Reset();
+
+    /// Append window samples (16 kHz mono).
+    void Append(const float* samples, size_t count);
+
+    /// Drop @p samples from the front of the window.  Must be a multiple
+    /// of HOP so the remaining frames stay aligned.
+    void DropFront(size_t samples);
+
+    /// Samples currently in the window.
+    size_t WindowSamples() const { return static_cast<size_t>(m_total - m_windowStart); }
+
+    /// Fill @p out with the normalized [n_mel][n_len] spectrogram of the
+    /// window plus 30 s of padding.  Returns n_len.
+    int Snapshot(std::vector<float>& out) const;
+
+private:
+    /// Frame @p frame of the stream, reflected at the window start like
+    /// whisper pads the start of its input, zeros past the end.
+    void ComputeFrame(int64_t frame, float* out) const;
+
+    /// Drop history no frame and no future window start can need.
+    void TrimHistory();
+
+    int                m_nMel;
+    std::vector<float> m_hann;       // N_FFT
+    std::vector<float> m_cos, m_sin; // (N_FFT/2+1) × N_FFT DFT basis
+    std::vector<float> m_filters;    // n_mel × (N_FFT/2+1)
+
+    // Absolute sample positions since Reset().
+    int64_t            m_total       = 0;
+    int64_t            m_windowStart = 0;     // multiple of HOP
+    int64_t            m_histBase    = 0;     // absolute index of m_hist[0]
+    std::vector<float> m_hist;                // the window, plus what future frames need
+
+    // Stable frames (all samples present), frame-major raw log10 values.
+    int64_t            m_firstFrame  = 0;     // absolute index of m_frames[0]
+    int64_t            m_nextFrame   = 0;     // next frame to compute
+    std::vector<float> m_frames;
+
+    // Snapshot() scratch for the frames it recomputes at either edge,
+    // reserved once so a pass doesn't allocate.
+    mutable std::vector<float> m_head;
+    mutable std::vector<float> m_tail;
+};
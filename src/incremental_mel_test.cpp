@@ -0,0 +1,222 @@
+// Checks IncrementalMel against a batch reference.
+//
+// The reference is whisper.cpp v1.5.5's log_mel_spectrogram() run on the
+// window's samples in one go: reflective padding at the start, 30 s of
+// zeros plus half a frame at the end, (n + 480000) / 160 frames, then
+// the clamp/normalize step.  The incremental spectrogram is fed the same
+// audio in uneven chunks, with the window start moved between
+// snapshots, and every snapshot must match the reference frame for frame.
+//
+// Both sides use IncrementalMel's own librosa-formula filter bank, so it
+// is checked separately against the mel_filters stored in the ggml model
+// whisper actually uses (skipped if the model hasn't been downloaded).
+//
+//   whisper-agent-mel-test [model.bin]
+
+#include "incremental_mel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static constexpr int      SAMPLE_RATE      = 16000;
+static constexpr int      N_FFT            = IncrementalMel::N_FFT;
+static constexpr int      HOP              = IncrementalMel::HOP;
+static constexpr int      N_BINS           = N_FFT / 2 + 1;
+static constexpr float    TOLERANCE        = 2e-3f;       // float DFT vs whisper's FFT
+static constexpr float    FILTER_TOLERANCE = 1e-6f;       // float32 rounding of the model's bank
+static constexpr uint32_t GGML_MAGIC       = 0x67676d6c;  // "ggml"
+static constexpr int      GGML_HPARAMS     = 11;          // int32 fields before mel_filters
+
+/// whisper.cpp's log_mel_spectrogram() for @p samples, with @p filters.
+static int batchMel(const std::vector<float>& samples, const std::vector<float>& filters,
+                    int nMel, std::vector<float>& out)
+{
+    const size_t n         = samples.size();
+    const size_t stage1Pad = SAMPLE_RATE * 30;
+    const size_t stage2Pad = N_FFT / 2;
+
+    std::vector<float> padded(n + stage1Pad + stage2Pad * 2, 0.0f);
+    std::copy(samples.begin(), samples.end(), padded.begin() + stage2Pad);
+    std::reverse_copy(samples.begin() + 1, samples.begin() + 1 + stage2Pad, padded.begin());
+
+    const int nLen = static_cast<int>((padded.size() - N_FFT) / HOP);
+    out.assign(static_cast<size_t>(nMel) * nLen, 0.0f);
+
+    std::vector<double> hann(N_FFT);
+    for (int i = 0; i < N_FFT; ++i)
+        hann[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / N_FFT));
+
+    for (int i = 0; i < nLen; ++i) {
+        const float* frame = &padded[static_cast<size_t>(i) * HOP];
+        bool silent = std::all_of(frame, frame + N_FFT, [](float v) { return v == 0.0f; });
+
+        double power[N_BINS] = {};
+        if (!silent) {
+            // Full spectrum, then fold the mirrored half like whisper does.
+            std::vector<double> full(N_FFT);
+            for (int k = 0; k < N_FFT; ++k) {
+                double re = 0.0, im = 0.0;
+                for (int j = 0; j < N_FFT; ++j) {
+                    double a = 2.0 * M_PI * k * j / N_FFT;
+                    re += hann[j] * frame[j] * std::cos(a);
+                    im -= hann[j] * frame[j] * std::sin(a);
+                }
+                full[k] = re * re + im * im;
+            }
+            for (int k = 1; k < N_FFT / 2; ++k)
+                full[k] += full[N_FFT - k];
+            std::copy(full.begin(), full.begin() + N_BINS, power);
+        }
+
+        for (int m = 0; m < nMel; ++m) {
+            double sum = 0.0;
+            for (int k = 0; k < N_BINS; ++k)
+                sum += power[k] * filters[static_cast<size_t>(m) * N_BINS + k];
+            out[static_cast<size_t>(m) * nLen + i] = static_cast<float>(std::log10(std::max(sum, 1e-10)));
+        }
+    }
+
+    float mmax = -1e20f;
+    for (float v : out) mmax = std::max(mmax, v);
+    for (float& v : out) v = (std::max(v, mmax - 8.0f) + 4.0f) / 4.0f;
+    return nLen;
+}
+
+/// A few drifting tones and some deterministic noise.
+static std::vector<float> testSignal(size_t count) {
+    std::vector<float> pcm(count);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < count; ++i) {
+        double t = static_cast<double>(i) / SAMPLE_RATE;
+        seed = seed * 1664525u + 1013904223u;
+        double noise = (static_cast<double>(seed >> 8) / (1u << 24) - 0.5) * 0.05;
+        pcm[i] = static_cast<float>(0.3 * std::sin(2.0 * M_PI * (220.0 + 40.0 * t) * t)
+                                  + 0.2 * std::sin(2.0 * M_PI * 1870.0 * t) * std::sin(3.0 * t)
+                                  + noise);
+    }
+    return pcm;
+}
+
+/// The mel_filters block of a ggml whisper model: magic, hparams, then
+/// n_mel, n_fft and the n_mel × n_fft bank.  False if unreadable.
+static bool loadModelFilters(const std::string& path, int& nMel, int& nBins,
+                             std::vector<float>& filters)
+{
+    std::ifstream in(path, std::ios::binary);
+    uint32_t magic = 0;
+    int32_t  header[GGML_HPARAMS + 2] = {};
+    if (!in.read(reinterpret_cast<char*>(&magic), sizeof magic) || magic != GGML_MAGIC
+        || !in.read(reinterpret_cast<char*>(header), sizeof header))
+        return false;
+    nMel  = header[GGML_HPARAMS];
+    nBins = header[GGML_HPARAMS + 1];
+    if (nMel <= 0 || nBins <= 0)
+        return false;
+    filters.resize(static_cast<size_t>(nMel) * nBins);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(filters.data()),
+                                     static_cast<std::streamsize>(filters.size() * sizeof(float))));
+}
+
+static int failures = 0;
+
+static void compareFilters(const std::string& modelPath) {
+    int nMel = 0, nBins = 0;
+    std::vector<float> want;
+    if (!loadModelFilters(modelPath, nMel, nBins, want)) {
+        std::printf("skip %-32s no model at %s\n", "filter bank", modelPath.c_str());
+        return;
+    }
+    IncrementalMel mel(nMel);
+    if (nBins != N_BINS) {
+        std::printf("FAIL %-32s model has %d bins, expected %d\n", "filter bank", nBins, N_BINS);
+        ++failures;
+        return;
+    }
+    float worst = 0.0f;
+    for (size_t i = 0; i < want.size(); ++i)
+        worst = std::max(worst, std::fabs(mel.Filters()[i] - want[i]));
+    bool ok = worst <= FILTER_TOLERANCE;
+    std::printf("%s %-32s %d mels, max diff %.2e\n",
+                ok ? "ok  " : "FAIL", "filter bank vs model", nMel, worst);
+    if (!ok) ++failures;
+}
+
+/// The reference reflects the first N_FFT/2 samples, so windows must be
+/// longer than that.
+static void compare(const IncrementalMel& mel, const std::vector<float>& pcm,
+                    size_t windowStart, size_t total, const char* what)
+{
+    std::vector<float> window(pcm.begin() + windowStart, pcm.begin() + total);
+    std::vector<float> got, want;
+    int nLen    = mel.Snapshot(got);
+    int nLenRef = batchMel(window, mel.Filters(), mel.NumMels(), want);
+
+    if (nLen != nLenRef) {
+        std::printf("FAIL %-32s n_len %d, reference %d\n", what, nLen, nLenRef);
+        ++failures;
+        return;
+    }
+    float worst = 0.0f;
+    int   worstFrame = 0;
+    for (int m = 0; m < mel.NumMels(); ++m)
+        for (int i = 0; i < nLen; ++i) {
+            float d = std::fabs(got[static_cast<size_t>(m) * nLen + i] - want[static_cast<size_t>(m) * nLen + i]);
+            if (d > worst) {
+                worst      = d;
+                worstFrame = i;
+            }
+        }
+    bool ok = worst <= TOLERANCE;
+    std::printf("%s %-32s n_len %d, max diff %.2e (frame %d)\n",
+                ok ? "ok  " : "FAIL", what, nLen, worst, worstFrame);
+    if (!ok) ++failures;
+}
+
+int main(int argc, char** argv) {
+    compareFilters(argc > 1 ? argv[1] : WHISPER_MODEL_PATH);
+
+    const std::vector<float> pcm = testSignal(SAMPLE_RATE * 4);
+    const size_t chunks[] = {1, 159, 160, 333, 1024, 2731};
+
+    IncrementalMel mel;
+    size_t total = 0, windowStart = 0, c = 0;
+    auto feed = [&](size_t upTo) {
+        while (total < upTo) {
+            size_t count = std::min(chunks[c++ % 6], upTo - total);
+            mel.Append(pcm.data() + total, count);
+            total += count;
+        }
+    };
+
+    feed(SAMPLE_RATE / 2);
+    compare(mel, pcm, windowStart, total, "initial window");
+
+    feed(SAMPLE_RATE + 77);
+    compare(mel, pcm, windowStart, total, "grown, frame straddling the end");
+
+    mel.DropFront(HOP * 90);
+    windowStart += HOP * 90;
+    compare(mel, pcm, windowStart, total, "front dropped");
+
+    feed(SAMPLE_RATE * 3);
+    mel.DropFront(HOP * 3);
+    windowStart += HOP * 3;
+    compare(mel, pcm, windowStart, total, "grown, small drop");
+
+    mel.DropFront(HOP * 150);
+    windowStart += HOP * 150;
+    feed(SAMPLE_RATE * 4);
+    compare(mel, pcm, windowStart, total, "drop then grow to the end");
+
+    mel.Reset();
+    total = windowStart = 0;
+    feed(SAMPLE_RATE * 2);
+    compare(mel, pcm, windowStart, total, "after reset");
+
+    return failures ? 1 : 0;
+}
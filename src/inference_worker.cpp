@@ -0,0 +1,246 @@
+#include "inference_worker.h"
+
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+
+extern char** environ;
+
+static constexpr int    POLL_MS      = 20;                        // reader wake-up for kill deadlines
+static constexpr size_t RING_SAMPLES = 48000 * 2 * 30;            // 30 s of 48 kHz stereo
+
+/// Move @p fd above the standard descriptors and RING_FD, so dup2 in the
+/// child never maps a descriptor onto itself (which would keep its
+/// close-on-exec flag).
+static int highFd(int fd) {
+    int moved = fcntl(fd, F_DUPFD_CLOEXEC, InferenceWorker::RING_FD + 1);
+    close(fd);
+    return moved;
+}
+
+InferenceWorker::InferenceWorker(std::string exe, ArgsProvider args,
+                                 LineHandler onLine, ExitHandler onExit)
+    : m_exe(std::move(exe))
+    , m_args(std::move(args))
+    , m_onLine(std::move(onLine))
+    , m_onExit(std::move(onExit))
+{}
+
+InferenceWorker::~InferenceWorker() {
+    // SIGKILL can't be blocked and doesn't wait for the encoder; the
+    // reader sees the socket close, reaps the child and returns.
+    m_shutdown = true;
+    {
+        std::lock_guard<std::mutex> lk(m_ioMutex);
+        if (m_pid > 0) kill(m_pid, SIGKILL);
+    }
+    if (m_reader.joinable())
+        m_reader.join();
+    if (m_ringFd >= 0)
+        close(m_ringFd);
+}
+
+bool InferenceWorker::Start() {
+    m_ring = SharedAudioRing::Create(RING_SAMPLES);
+    if (!m_ring) return false;
+    m_ringFd = fcntl(m_ring->Fd(), F_DUPFD_CLOEXEC, RING_FD + 1);
+    if (m_ringFd < 0) return false;
+
+    {
+        std::lock_guard<std::mutex> lk(m_ioMutex);
+        if (!Spawn()) return false;
+    }
+    m_reader = std::thread(&InferenceWorker::ReaderLoop, this);
+    return true;
+}
+
+bool InferenceWorker::Spawn() {
+    int sv[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sv) != 0)
+        return false;
+    int ours   = highFd(sv[0]);
+    int theirs = highFd(sv[1]);
+    if (ours < 0 || theirs < 0) {
+        if (ours >= 0) close(ours);
+        if (theirs >= 0) close(theirs);
+        return false;
+    }
+
+    std::vector<std::string> args = m_args();
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(m_exe.c_str()));
+    for (auto& a : args) argv.push_back(const_cast<char*>(a.c_str()));
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, theirs, STDIN_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, theirs, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, m_ringFd, RING_FD);
+
+    pid_t pid = -1;
+    int rc = posix_spawn(&pid, m_exe.c_str(), &actions, nullptr, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    close(theirs);
+    if (rc != 0) {
+        close(ours);
+        return false;
+    }
+
+    m_pid    = pid;
+    m_socket = ours;
+    m_killed = false;
+
+    // Settings first, then whatever queued up while no worker ran.
+    std::vector<std::string> lines = m_sticky;
+    lines.insert(lines.end(), m_held.begin(), m_held.end());
+    m_held.clear();
+    for (const auto& line : lines)
+        Write(line);
+    return true;
+}
+
+void InferenceWorker::Write(const std::string& line) {
+    if (m_socket < 0 || m_killed) {
+        m_held.push_back(line);
+        return;
+    }
+    std::string out = line + '\n';
+    size_t sent = 0;
+    while (sent < out.size()) {
+        // MSG_NOSIGNAL: a dead worker is an error here, not SIGPIPE.
+        ssize_t n = send(m_socket, out.data() + sent, out.size() - sent, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) {
+            // Gone; the reader restarts it and the line goes to the next one.
+            if (sent == 0) m_held.push_back(line);
+            return;
+        }
+        sent += static_cast<size_t>(n);
+    }
+}
+
+void InferenceWorker::Send(const std::string& line, bool sticky) {
+    std::lock_guard<std::mutex> lk(m_ioMutex);
+    if (sticky) {
+        std::string verb = line.substr(0, line.find(' '));
+        bool replaced = false;
+        for (auto& s : m_sticky)
+            if (s.substr(0, s.find(' ')) == verb) {
+                s = line;
+                replaced = true;
+            }
+        if (!replaced) m_sticky.push_back(line);
+        // A worker that isn't up yet gets it from the sticky list.
+        if (m_socket < 0 || m_killed) return;
+    }
+    Write(line);
+}
+
+void InferenceWorker::KillUnlessIdle(int graceMs) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(graceMs);
+    m_killDeadline = deadline.time_since_epoch().count();
+}
+
+void InferenceWorker::ReaderLoop() {
+    std::string pending;
+    char buf[4096];
+
+    while (!m_shutdown) {
+        int fd;
+        {
+            std::lock_guard<std::mutex> lk(m_ioMutex);
+            fd = m_socket;
+        }
+        bool gone = fd < 0;
+
+        if (!gone) {
+            pollfd p = {fd, POLLIN, 0};
+            if (poll(&p, 1, POLL_MS) > 0) {
+                ssize_t n = read(fd, buf, sizeof(buf));
+                if (n > 0) {
+                    pending.append(buf, static_cast<size_t>(n));
+                    size_t eol;
+                    while ((eol = pending.find('\n')) != std::string::npos) {
+                        std::string line = pending.substr(0, eol);
+                        pending.erase(0, eol + 1);
+                        if (line == "idle") m_killDeadline = 0;
+                        m_onLine(line);
+                    }
+                } else if (n == 0 || (errno != EINTR && errno != EAGAIN)) {
+                    gone = true;
+                }
+            }
+
+            // Still busy after a cancel: stuck in a pass that can't be
+            // interrupted.  Kill it; the socket closing ends up above.
+            int64_t deadline = m_killDeadline.load();
+            if (!gone && deadline != 0
+                && std::chrono::steady_clock::now().time_since_epoch().count() > deadline)
+            {
+                m_killDeadline = 0;
+                std::lock_guard<std::mutex> lk(m_ioMutex);
+                if (m_pid > 0 && !m_killed) {
+                    kill(m_pid, SIGKILL);
+                    m_killed = true;
+                }
+            }
+        }
+        if (!gone) continue;
+
+        bool killed;
+        {
+            std::lock_guard<std::mutex> lk(m_ioMutex);
+            if (m_pid > 0) {
+                kill(m_pid, SIGKILL);   // closed its end but hasn't exited
+                waitpid(m_pid, nullptr, 0);
+            }
+            if (m_socket >= 0) close(m_socket);
+            m_pid    = -1;
+            m_socket = -1;
+            killed   = m_killed;
+            m_killed = false;
+        }
+        m_killDeadline = 0;
+        pending.clear();
+
+        if (m_shutdown || !m_onExit(killed))
+            break;
+        std::lock_guard<std::mutex> lk(m_ioMutex);
+        Spawn();   // on failure the next iteration reports it as an exit
+    }
+}
+
+std::string InferenceWorker::Escape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        switch (c) {
+        case '\n': out += "\\n";  break;
+        case '\r': out += "\\r";  break;
+        case '\\': out += "\\\\"; break;
+        default:   out += c;      break;
+        }
+    }
+    return out;
+}
+
+std::string InferenceWorker::Unescape(const std::string& text) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] != '\\' || i + 1 == text.size()) {
+            out += text[i];
+            continue;
+        }
+        char c = text[++i];
+        out += c == 'n' ? '\n' : c == 'r' ? '\r' : c;
+    }
+    return out;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "shared_audio_ring.h"
+
+/// A whisper-agent-worker child process that owns the models, and the
+/// channels to it: a SharedAudioRing for captured audio (inherited as
+/// RING_FD) and a socket pair on its stdin/stdout for commands and
+/// results, one line each, text escaped with Escape():
+///
+///   app → worker   start <rate> <channels> <ring-pos>
+///                  command <rate> <channels> <ring-pos>
+///                  stop, cancel, recalibrate, vocab <phrase>\t<phrase>...
+///   worker → app   model <state> <percent>, threads <n> <calibrated>,
+///                  partial <text>, final <text>, nofinal,
+///                  command <index> <text>, idle
+///
+/// A reader thread hands every line from the worker to the line handler.
+/// When the worker exits (a crash, or Kill) the exit handler decides
+/// whether to start another.  Lines sent while none is running are held
+/// for the next one, and sticky lines are replayed to every new worker.
+class InferenceWorker {
+public:
+    static constexpr int RING_FD = 3;   // the ring's descriptor in the worker
+
+    using LineHandler = std::function<void(const std::string&)>;
+    /// Called on the reader thread once the worker is gone; @p killed
+    /// says this side killed it.  Return true to start a new one.
+    using ExitHandler = std::function<bool(bool killed)>;
+    /// Arguments for the worker, asked for at every (re)start.
+    using ArgsProvider = std::function<std::vector<std::string>()>;
+
+    /// @param exe  Absolute path of the worker executable.
+    InferenceWorker(std::string exe, ArgsProvider args, LineHandler onLine, ExitHandler onExit);
+
+    /// Kills the worker without waiting for whatever it's doing.
+    ~InferenceWorker();
+
+    InferenceWorker(const InferenceWorker&) = delete;
+    InferenceWorker& operator=(const InferenceWorker&) = delete;
+
+    /// Create the ring and start the worker.  Returns false if either
+    /// fails.
+    bool Start();
+
+    SharedAudioRing& Ring() { return *m_ring; }
+
+    /// Send one command line.  A @p sticky line is also replayed to every
+    /// restarted worker (only the latest per verb).
+    void Send(const std::string& line, bool sticky = false);
+
+    /// Kill the worker unless it answers "idle" within @p graceMs.
+    void KillUnlessIdle(int graceMs);
+
+    /// Text ↔ single protocol line (backslash escapes for \n, \r, \\).
+    static std::string Escape(const std::string& text);
+    static std::string Unescape(const std::string& text);
+
+private:
+    bool Spawn();                       // m_ioMutex held
+    void Write(const std::string& line); // m_ioMutex held; holds the line on failure
+    void ReaderLoop();
+
+    std::string                      m_exe;
+    ArgsProvider                     m_args;
+    LineHandler                      m_onLine;
+    ExitHandler                      m_onExit;
+    std::unique_ptr<SharedAudioRing> m_ring;
+    int                              m_ringFd = -1;   // dup of the ring above RING_FD
+
+    std::mutex               m_ioMutex;   // guards the members below
+    std::vector<std::string> m_sticky;
+    std::vector<std::string> m_held;      // sent while no worker was running
+    int                      m_pid    = -1;
+    int                      m_socket = -1;
+    bool                     m_killed = false;   // SIGKILL sent, exit not yet reaped
+
+    std::atomic<int64_t>     m_killDeadline{0};  // steady_clock ticks; 0 = none
+    std::atomic<bool>        m_shutdown{false};
+    std::thread              m_reader;
+};
@@ -0,0 +1,122 @@
+#include "latency_monitor.h"
+
+#include <algorithm>
+#include <cstdio>
+
+static constexpr size_t WINDOW       = 200;    // samples kept per interval
+static constexpr size_t LOG_CAPACITY = 1000;   // finished traces kept for Dump()
+
+static double ticksToMs(int64_t ticks) {
+    return std::chrono::duration<double, std::milli>(
+        LatencyMonitor::Clock::duration(ticks)).count();
+}
+
+uint64_t LatencyMonitor::Begin(Clock::time_point captured, Clock::time_point snapshot,
+                               bool isFinal)
+{
+    std::lock_guard<std::mutex> lk(m_mutex);
+    uint64_t id = m_nextId++;
+    Trace& t = m_traces[id % m_traces.size()];
+    t = Trace{};
+    t.id    = id;
+    t.final = isFinal;
+    // No capture time yet (e.g. fed audio before the first callback):
+    // start the trace at the snapshot.
+    if (captured.time_since_epoch().count() == 0) captured = snapshot;
+    t.at[Captured] = captured.time_since_epoch().count();
+    t.at[Snapshot] = snapshot.time_since_epoch().count();
+    return id;
+}
+
+LatencyMonitor::Trace* LatencyMonitor::Find(uint64_t id) {
+    if (id == 0) return nullptr;
+    Trace& t = m_traces[id % m_traces.size()];
+    return t.id == id ? &t : nullptr;
+}
+
+void LatencyMonitor::Mark(uint64_t id, Stage stage, Clock::time_point t) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Trace* trace = Find(id);
+    if (!trace || trace->at[stage] != 0) return;
+    trace->at[stage] = t.time_since_epoch().count();
+    if (stage == Dispatched)
+        m_lastDispatched = id;
+}
+
+void LatencyMonitor::Finish(uint64_t id) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    Trace* trace = Find(id);
+    if (!trace) return;
+
+    // Final traces are logged but kept out of the rolling windows: a
+    // final pass runs a different model over a different span.
+    if (!trace->final) {
+        for (auto& iv : m_intervals) {
+            if (trace->at[iv.from] == 0 || trace->at[iv.to] == 0) continue;
+            double ms = ticksToMs(trace->at[iv.to] - trace->at[iv.from]);
+            if (iv.samples.size() < WINDOW)
+                iv.samples.push_back(ms);
+            else
+                iv.samples[iv.next] = ms;
+            iv.next = (iv.next + 1) % WINDOW;
+        }
+    }
+
+    if (m_log.size() >= LOG_CAPACITY)
+        m_log.erase(m_log.begin(), m_log.begin() + LOG_CAPACITY / 4);
+    m_log.push_back(*trace);
+    trace->id = 0;   // finished — later marks are ignored
+}
+
+uint64_t LatencyMonitor::LastDispatched() const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_lastDispatched;
+}
+
+double LatencyMonitor::Percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    size_t k = std::min(v.size() - 1, static_cast<size_t>(p * v.size()));
+    std::nth_element(v.begin(), v.begin() + k, v.end());
+    return v[k];
+}
+
+std::string LatencyMonitor::Summary() const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    const auto& total = m_intervals.back().samples;
+    if (total.empty()) return "";
+    char buf[96];
+    std::snprintf(buf, sizeof(buf), "Latency p50 %.0f ms, p95 %.0f ms",
+                  Percentile(total, 0.5), Percentile(total, 0.95));
+    return buf;
+}
+
+bool LatencyMonitor::Dump(const std::string& path) const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    std::fprintf(f, "# whisper-agent dictation latency (partial passes, last %zu)\n", WINDOW);
+    std::fprintf(f, "# %-8s %6s %9s %9s %9s\n", "stage", "n", "p50_ms", "p95_ms", "max_ms");
+    for (const auto& iv : m_intervals) {
+        double mx = iv.samples.empty() ? 0.0
+                  : *std::max_element(iv.samples.begin(), iv.samples.end());
+        std::fprintf(f, "# %-8s %6zu %9.1f %9.1f %9.1f\n", iv.name, iv.samples.size(),
+                     Percentile(iv.samples, 0.5), Percentile(iv.samples, 0.95), mx);
+    }
+
+    std::fprintf(f, "id,kind");
+    for (const auto& iv : m_intervals) std::fprintf(f, ",%s_ms", iv.name);
+    std::fprintf(f, "\n");
+    for (const auto& t : m_log) {
+        std::fprintf(f, "%llu,%s", static_cast<unsigned long long>(t.id),
+                     t.final ? "final" : "partial");
+        for (const auto& iv : m_intervals) {
+            if (t.at[iv.from] == 0 || t.at[iv.to] == 0)
+                std::fprintf(f, ",");
+            else
+                std::fprintf(f, ",%.1f", ticksToMs(t.at[iv.to] - t.at[iv.from]));
+        }
+        std::fprintf(f, "\n");
+    }
+    return std::fclose(f) == 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// End-to-end latency of dictation passes, from the audio callback to
+/// the text appearing in the dialog.
+///
+/// Each partial or final pass opens a trace.  The threads that pass
+/// through it mark each stage, and Finish() folds the stage-to-stage
+/// intervals into rolling windows for percentiles.  The UI thread calls
+/// Finish() after it has displayed the text.  Unfinished traces (aborted
+/// passes, partials superseded before display, events the dialog
+/// ignored) simply age out.  Thread-safe; not for the real-time audio
+/// thread.
+class LatencyMonitor {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    enum Stage {
+        Captured,       // newest sample in the pass arrived from the audio callback
+        Snapshot,       // streaming loop took the window and started the pass
+        EncodeBegin,    // whisper's encoder started (mel + prompt set up)
+        DecodeBegin,    // first decoder step (encoder done)
+        InferenceEnd,   // whisper_full returned
+        Dispatched,     // transcription callback invoked
+        Delivered,      // MainFrame::OnTranscription received the event
+        Displayed,      // TranscriptionDialog::UpdateText returned
+        STAGE_COUNT
+    };
+
+    /// Open a trace.  Returns its id (never 0).
+    uint64_t Begin(Clock::time_point captured, Clock::time_point snapshot, bool isFinal);
+
+    /// Record when @p stage happened.  The first mark of a stage wins,
+    /// so per-window or per-token hooks can mark unconditionally.
+    /// Unknown or expired ids are ignored.
+    void Mark(uint64_t id, Stage stage, Clock::time_point t = Clock::now());
+
+    /// Fold a completed trace into the statistics and the log.
+    void Finish(uint64_t id);
+
+    /// Id of the trace most recently marked Dispatched, so the callback
+    /// can tag the UI event it posts.
+    uint64_t LastDispatched() const;
+
+    /// One-line summary of end-to-end partial latency, for the status bar.
+    std::string Summary() const;
+
+    /// Per-stage percentiles plus the recent trace log, as CSV with a
+    /// commented header.  Returns false if @p path can't be written.
+    bool Dump(const std::string& path) const;
+
+private:
+    struct Trace {
+        uint64_t id    = 0;
+        bool     final = false;
+        int64_t  at[STAGE_COUNT] = {};   // steady_clock ticks; 0 = not reached
+    };
+
+    /// Interval between two stages, tracked as rolling samples in ms.
+    struct Interval {
+        const char*         name;
+        Stage               from, to;
+        std::vector<double> samples;     // ring of the last WINDOW values
+        size_t              next = 0;
+    };
+
+    Trace* Find(uint64_t id);
+    static double Percentile(std::vector<double> v, double p);
+
+    mutable std::mutex    m_mutex;
+    uint64_t              m_nextId = 1;
+    uint64_t              m_lastDispatched = 0;
+    std::vector<Trace>    m_traces = std::vector<Trace>(64);   // by id % size
+    std::vector<Interval> m_intervals = {
+        {"queue",   Captured,     Snapshot,     {}},
+        {"prepare", Snapshot,     EncodeBegin,  {}},
+        {"encode",  EncodeBegin,  DecodeBegin,  {}},
+        {"decode",  DecodeBegin,  InferenceEnd, {}},
+        {"post",    InferenceEnd, Dispatched,   {}},
+        {"event",   Dispatched,   Delivered,    {}},
+        {"display", Delivered,    Displayed,    {}},
+        {"total",   Captured,     Displayed,    {}},
+    };
+    std::vector<Trace>    m_log;                                // finished, oldest first
+};
@@ -1,4 +1,6 @@
 #include <wx/wx.h>
+#include <cstring>
+#include "headless.h"
 #include "main_frame.h"
 
 class WhisperAgentApp : public wxApp {
@@ -13,4 +15,11 @@ public:
     }
 };
 
-wxIMPLEMENT_APP(WhisperAgentApp);
+wxIMPLEMENT_APP_NO_MAIN(WhisperAgentApp);
+
+int main(int argc, char** argv) {
+    // Headless mode never starts wxWidgets, so it runs without a display.
+    if (argc > 1 && std::strcmp(argv[1], "--headless") == 0)
+        return RunHeadless(argc - 1, argv + 1);
+    return wxEntry(argc, argv);
+}
@@ -2,6 +2,32 @@
 
 #include <wx/stdpaths.h>
 #include <wx/filename.h>
+#include <algorithm>
+#include <thread>
+
+static wxString ConfigFilePath() {
+    return wxStandardPaths::Get().GetUserConfigDir() + "/whisper-agent.conf";
+}
+
+/// Keys a voice command sends, as written in the config file: \r, \n,
+/// \t and \e (Esc) escapes, and a doubled backslash for a literal one.
+static std::string UnescapeKeys(const wxString& value) {
+    std::string in = value.ToStdString(wxConvUTF8), out;
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] != '\\' || i + 1 == in.size()) {
+            out += in[i];
+            continue;
+        }
+        switch (in[++i]) {
+        case 'r': out += '\r';   break;
+        case 'n': out += '\n';   break;
+        case 't': out += '\t';   break;
+        case 'e': out += '\x1b'; break;
+        default:  out += in[i];  break;
+        }
+    }
+    return out;
+}
 
 // ===================================================================
 // TranscriptionDialog
@@ -64,12 +90,39 @@ TranscriptionDialog::TranscriptionDialog(wxWindow* parent)
 }
 
 void TranscriptionDialog::UpdateText(const wxString& text) {
-    m_text->SetValue(text);
+    // Consecutive partials mostly share a prefix — the confirmed text
+    // never changes and the open phrase grows at the end.  Rewrite only
+    // from the first difference, which keeps long dictations from
+    // relaying out the whole control on every partial.
+    size_t common = 0;
+    size_t limit  = std::min(text.length(), m_shown.length());
+    while (common < limit && text[common] == m_shown[common])
+        ++common;
+    if (common == text.length() && common == m_shown.length())
+        return;
+
+    m_text->Freeze();
+    if (common < m_shown.length())
+        m_text->Remove(static_cast<long>(common), m_text->GetLastPosition());
+    if (common < text.length())
+        m_text->AppendText(text.Mid(common));
+    m_text->Thaw();
+    m_shown = text;
+}
+
+void TranscriptionDialog::SetFinalizing() {
+    if (m_finalized || m_finalizing) return;
+    m_finalizing = true;
+
+    m_status->SetLabel("  Finalizing...");
+    m_stopBtn->Disable();
+    m_sendBtn->Disable();
 }
 
 void TranscriptionDialog::Finalize() {
     if (m_finalized) return;   // idempotent
-    m_finalized = true;
+    m_finalized  = true;
+    m_finalizing = false;
 
     m_status->SetLabel("  Edit then press Enter to send, Esc to cancel");
     m_stopBtn->Hide();
@@ -93,28 +146,58 @@ MainFrame::MainFrame(const wxString& command)
     : wxFrame(nullptr, wxID_ANY, "Whisper Agent", wxDefaultPosition, wxSize(1400, 900))
 {
     SetMinSize(wxSize(800, 600));
+    ConfigureThreadPlacement();
     LoadRecentFolders();
     CreateMenuBar();
     CreateUI(command);
 
-    if (!m_transcriber.Init(WHISPER_MODEL_PATH)) {
+    // Background thread → main thread.  Results go through a mailbox
+    // that keeps only the newest partial; the event just says "look",
+    // and is only posted when the mailbox was empty.
+    m_transcriber.SetCallback([this](const std::string& text, bool isFinal) {
+        if (m_transcripts.Post(text, isFinal, m_transcriber.Latency().LastDispatched()))
+            wxQueueEvent(this, new wxThreadEvent(wxEVT_THREAD, ID_TRANSCRIPTION));
+    });
+
+    // Command session result.  Int: vocabulary index or -1, String: heard.
+    m_transcriber.SetCommandCallback([this](int index, const std::string& heard) {
+        auto* evt = new wxThreadEvent(wxEVT_THREAD, ID_COMMAND_RESULT);
+        evt->SetString(wxString::FromUTF8(heard));
+        evt->SetInt(index);
+        wxQueueEvent(this, evt);
+    });
+
+    // Model load progress.  Int: percent, ExtraLong: ModelState.
+    m_transcriber.SetModelCallback([this](Transcriber::ModelState state, int percent) {
+        auto* evt = new wxThreadEvent(wxEVT_THREAD, ID_MODEL_STATUS);
+        evt->SetInt(percent);
+        evt->SetExtraLong(static_cast<long>(state));
+        wxQueueEvent(this, evt);
+    });
+
+    // Loads in the background; Record works right away and the audio
+    // is transcribed once the model is ready.
+    LoadTranscriberSettings();
+    LoadVoiceCommands();
+
+    // Bias recognition toward the open project's file names and
+    // identifiers.  Scanned in the background, updated as files change.
+    m_vocabulary.SetListener([this](const std::vector<std::string>& terms) {
+        m_transcriber.SetGlossary(terms);
+    });
+    m_vocabulary.SetRoot(m_fileTree->GetRootDir().ToStdString(wxConvUTF8));
+    if (!m_transcriber.Init(WHISPER_MODEL_PATH, WHISPER_FINAL_MODEL_PATH)) {
         wxLogWarning("Could not load whisper model from:\n%s\n\n"
                      "Voice transcription will be unavailable.\n"
                      "The model is downloaded during CMake configure.",
                      WHISPER_MODEL_PATH);
     }
 
-    // Background thread → main-thread event.
-    // Int: 0 = partial, 1 = final.
-    m_transcriber.SetCallback([this](const std::string& text, bool isFinal) {
-        auto* evt = new wxThreadEvent(wxEVT_THREAD);
-        evt->SetString(wxString::FromUTF8(text));
-        evt->SetInt(isFinal ? 1 : 0);
-        wxQueueEvent(this, evt);
-    });
-
     Bind(EVT_FILE_SELECTED, &MainFrame::OnFileSelected, this);
-    Bind(wxEVT_THREAD,      &MainFrame::OnTranscription, this);
+    Bind(EVT_TREE_CHANGED,  &MainFrame::OnTreeChanged,  this);
+    Bind(wxEVT_THREAD,      &MainFrame::OnTranscription, this, ID_TRANSCRIPTION);
+    Bind(wxEVT_THREAD,      &MainFrame::OnModelStatus,   this, ID_MODEL_STATUS);
+    Bind(wxEVT_THREAD,      &MainFrame::OnCommandResult, this, ID_COMMAND_RESULT);
 
     // Delayed Enter keypress after injecting text into the terminal
     m_enterTimer.SetOwner(this);
@@ -130,6 +213,8 @@ MainFrame::MainFrame(const wxString& command)
 
 MainFrame::~MainFrame() {
     m_transcriber.SetCallback(nullptr);
+    m_transcriber.SetModelCallback(nullptr);
+    m_transcriber.SetCommandCallback(nullptr);
     m_transcriber.CancelRecording();
     if (m_dlg) {
         m_dlg->Destroy();
@@ -154,12 +239,28 @@ void MainFrame::CreateMenuBar() {
     fileMenu->AppendSeparator();
     fileMenu->Append(wxID_EXIT, "&Quit\tCtrl+Q");
 
+    auto* voiceMenu = new wxMenu();
+    voiceMenu->Append(ID_VOICE_COMMAND, "Voice C&ommand\tCtrl+Shift+Space",
+                      "Say one short command (yes, continue, enter, cancel...) and send its keys");
+    voiceMenu->AppendSeparator();
+    voiceMenu->Append(ID_RECALIBRATE, "Re&calibrate Transcription Speed",
+                      "Time whisper at several thread counts and keep the fastest");
+    voiceMenu->Append(ID_THREAD_PLACEMENT, "Thread &Placement...",
+                      "Show which CPUs the audio, inference and UI threads run on");
+    voiceMenu->Append(ID_DUMP_LATENCY, "Save &Latency Log...",
+                      "Write per-stage dictation latency percentiles and recent passes to a file");
+
     menuBar->Append(fileMenu, "&File");
+    menuBar->Append(voiceMenu, "&Voice");
     SetMenuBar(menuBar);
 
     Bind(wxEVT_MENU, &MainFrame::OnOpenFolder,  this, wxID_OPEN);
     Bind(wxEVT_MENU, &MainFrame::OnQuit,        this, wxID_EXIT);
     Bind(wxEVT_MENU, &MainFrame::OnClearRecent,  this, ID_CLEAR_RECENT);
+    Bind(wxEVT_MENU, &MainFrame::OnRecalibrate,  this, ID_RECALIBRATE);
+    Bind(wxEVT_MENU, &MainFrame::OnThreadPlacement, this, ID_THREAD_PLACEMENT);
+    Bind(wxEVT_MENU, &MainFrame::OnDumpLatency,  this, ID_DUMP_LATENCY);
+    Bind(wxEVT_MENU, &MainFrame::OnVoiceCommand, this, ID_VOICE_COMMAND);
     Bind(wxEVT_MENU, &MainFrame::OnOpenRecent,   this,
          ID_RECENT_BASE, ID_RECENT_BASE + MAX_RECENT - 1);
 }
@@ -191,12 +292,36 @@ void MainFrame::OnClearRecent(wxCommandEvent&) {
     });
 }
 
+void MainFrame::OnRecalibrate(wxCommandEvent&) {
+    if (m_dlg || !m_transcriber.Recalibrate())
+        SetStatusText("Can't recalibrate while recording or loading");
+}
+
+void MainFrame::OnThreadPlacement(wxCommandEvent&) {
+    wxString text = wxString::FromUTF8(m_placement.Describe());
+    text += wxString::Format("\nWhisper threads per pass: %d\n"
+                             "Configure under [Threads] in %s",
+                             m_transcriber.ThreadCount(), ConfigFilePath());
+    wxMessageBox(text, "Thread Placement", wxOK | wxICON_INFORMATION, this);
+}
+
+void MainFrame::OnDumpLatency(wxCommandEvent&) {
+    wxFileDialog dlg(this, "Save Latency Log", wxGetHomeDir(), "whisper-agent-latency.csv",
+                     "CSV files (*.csv)|*.csv", wxFD_SAVE | wxFD_OVERWRITE_PROMPT);
+    if (dlg.ShowModal() != wxID_OK) return;
+    if (m_transcriber.Latency().Dump(dlg.GetPath().ToStdString(wxConvUTF8)))
+        SetStatusText("Latency log saved to " + dlg.GetPath());
+    else
+        SetStatusText("Could not write " + dlg.GetPath());
+}
+
 void MainFrame::OnQuit(wxCommandEvent&) {
     Close();
 }
 
 void MainFrame::OpenFolder(const wxString& path) {
     m_fileTree->SetRootDir(path);
+    m_vocabulary.SetRoot(path.ToStdString(wxConvUTF8));
     m_terminal->Restart(path);
     AddRecentFolder(path);
     SetTitle("Whisper Agent \u2014 " + path);
@@ -218,8 +343,7 @@ void MainFrame::AddRecentFolder(const wxString& path) {
 }
 
 void MainFrame::LoadRecentFolders() {
-    wxString configDir = wxStandardPaths::Get().GetUserConfigDir();
-    wxString configPath = configDir + "/whisper-agent.conf";
+    wxString configPath = ConfigFilePath();
     if (!wxFileExists(configPath)) return;
 
     wxFileConfig cfg("", "", configPath);
@@ -233,10 +357,7 @@ void MainFrame::LoadRecentFolders() {
 }
 
 void MainFrame::SaveRecentFolders() {
-    wxString configDir = wxStandardPaths::Get().GetUserConfigDir();
-    wxString configPath = configDir + "/whisper-agent.conf";
-
-    wxFileConfig cfg("", "", configPath);
+    wxFileConfig cfg("", "", ConfigFilePath());
     cfg.DeleteGroup("/RecentFolders");
     cfg.SetPath("/RecentFolders");
     for (int i = 0; i < static_cast<int>(m_recentFolders.size()); ++i)
@@ -244,6 +365,103 @@ void MainFrame::SaveRecentFolders() {
     cfg.Flush();
 }
 
+void MainFrame::ConfigureThreadPlacement() {
+    ThreadPlacement::Policy policy;
+    wxString configPath = ConfigFilePath();
+    if (wxFileExists(configPath)) {
+        wxFileConfig cfg("", "", configPath);
+        cfg.SetPath("/Threads");
+        long cores = 0;
+        cfg.Read("placement", &policy.enabled);
+        cfg.Read("realtimeAudio", &policy.realtimeAudio);
+        cfg.Read("inferenceCores", &cores);
+        policy.inferenceCores = static_cast<int>(cores);
+    }
+
+    // Runs before the terminal starts, so with placement=1 the agent and
+    // anything it spawns inherit the UI thread's CPUs and stay off
+    // inference's.
+    m_placement.Configure(policy);
+    m_placement.ApplyToCurrentThread(ThreadRole::Ui);
+    m_transcriber.SetThreadPlacement(&m_placement);
+}
+
+void MainFrame::LoadTranscriberSettings() {
+    wxString configPath = ConfigFilePath();
+    if (!wxFileExists(configPath)) return;   // first run → calibrate
+
+    wxFileConfig cfg("", "", configPath);
+    cfg.SetPath("/Transcriber");
+    long threads = 0, cores = 0;
+    cfg.Read("threads", &threads);
+    cfg.Read("calibratedCores", &cores);
+
+    bool compact = false, autoGain = true, adaptiveContext = true;
+    cfg.Read("compactAudio", &compact);
+    cfg.Read("autoGain", &autoGain);
+    cfg.Read("adaptiveContext", &adaptiveContext);
+    m_transcriber.SetCompactAudio(compact);
+    m_transcriber.SetAutoGain(autoGain);
+    m_transcriber.SetAdaptiveContext(adaptiveContext);
+
+    // Optionally keep the models in a separate process that Cancel can
+    // kill outright.  It's installed next to the app.
+    bool worker = false;
+    cfg.Read("worker", &worker);
+    if (worker) {
+        wxFileName exe(wxStandardPaths::Get().GetExecutablePath());
+        exe.SetFullName("whisper-agent-worker");
+        if (exe.FileExists())
+            m_transcriber.SetWorkerPath(exe.GetFullPath().ToStdString(wxConvUTF8));
+        else
+            SetStatusText("whisper-agent-worker not found \u2014 transcribing in-process");
+    }
+
+    // A calibration from different hardware (or a VM resized since)
+    // doesn't apply — leave it at 0 so the warmup calibrates again.
+    if (threads > 0 && cores == static_cast<long>(std::thread::hardware_concurrency()))
+        m_transcriber.SetThreadCount(static_cast<int>(threads));
+}
+
+void MainFrame::SaveTranscriberSettings() {
+    wxFileConfig cfg("", "", ConfigFilePath());
+    cfg.SetPath("/Transcriber");
+    cfg.Write("threads", static_cast<long>(m_transcriber.ThreadCount()));
+    cfg.Write("calibratedCores", static_cast<long>(std::thread::hardware_concurrency()));
+    cfg.Flush();
+}
+
+void MainFrame::LoadVoiceCommands() {
+    // [Commands] maps each phrase to the keys it sends, e.g.
+    // "continue=continue\r".  If the group exists it replaces the defaults.
+    m_commands = {
+        {"yes",      "yes\r"},
+        {"no",       "no\r"},
+        {"continue", "continue\r"},
+        {"enter",    "\r"},
+        {"cancel",   "\x1b"},
+    };
+
+    wxString configPath = ConfigFilePath();
+    if (wxFileExists(configPath)) {
+        wxFileConfig cfg("", "", configPath);
+        cfg.SetPath("/Commands");
+        if (cfg.GetNumberOfEntries() > 0) {
+            m_commands.clear();
+            wxString name;
+            long     cookie;
+            for (bool more = cfg.GetFirstEntry(name, cookie); more;
+                 more = cfg.GetNextEntry(name, cookie))
+                m_commands.push_back({name, UnescapeKeys(cfg.Read(name, ""))});
+        }
+    }
+
+    std::vector<std::string> phrases;
+    for (const auto& c : m_commands)
+        phrases.push_back(c.phrase.ToStdString(wxConvUTF8));
+    m_transcriber.SetCommandVocabulary(phrases);
+}
+
 void MainFrame::RebuildRecentMenu() {
     // Clear existing items
     while (m_recentMenu->GetMenuItemCount() > 0)
@@ -312,6 +530,12 @@ void MainFrame::CreateUI(const wxString& command) {
     m_recordBtn->Bind(wxEVT_BUTTON, &MainFrame::OnRecord, this);
     barSizer->Add(m_recordBtn, 0, wxALL | wxALIGN_CENTER_VERTICAL, 4);
 
+    m_commandBtn = new wxButton(bottomBar, wxID_ANY, "Command");
+    m_commandBtn->SetToolTip("Say one short command (yes, continue, enter, cancel...) "
+                             "and send it straight to the terminal (Ctrl+Shift+Space)");
+    m_commandBtn->Bind(wxEVT_BUTTON, &MainFrame::OnVoiceCommand, this);
+    barSizer->Add(m_commandBtn, 0, wxTOP | wxBOTTOM | wxRIGHT | wxALIGN_CENTER_VERTICAL, 4);
+
     auto* hint = new wxStaticText(bottomBar, wxID_ANY, "  Whisper Agent \u2014 press to dictate a command");
     hint->SetForegroundColour(wxColour(120, 120, 120));
     barSizer->Add(hint, 1, wxALL | wxALIGN_CENTER_VERTICAL, 4);
@@ -328,7 +552,10 @@ void MainFrame::CreateUI(const wxString& command) {
     sizer->Add(mainSplit, 1, wxEXPAND);
     SetSizer(sizer);
 
-    CreateStatusBar(2);
+    // Fields: messages, current folder/file, dictation latency.
+    CreateStatusBar(3);
+    const int widths[] = {-2, -3, 230};
+    SetStatusWidths(3, widths);
     SetStatusText("Ready");
     if (!m_recentFolders.empty()) {
         SetTitle("Whisper Agent \u2014 " + initialDir);
@@ -341,10 +568,12 @@ void MainFrame::CreateUI(const wxString& command) {
 // -------------------------------------------------------------------
 
 void MainFrame::OnRecord(wxCommandEvent&) {
-    if (m_dlg) return;   // already open
+    if (m_dlg || m_listeningForCommand) return;   // already open
 
     // Start capturing audio FIRST so nothing the user says is lost
-    // while the dialog is being created and shown.
+    // while the dialog is being created and shown.  Anything a previous
+    // session left in the mailbox isn't for this dialog.
+    m_transcripts.TakeAll();
     m_transcriber.StartRecording();
 
     m_dlg = new TranscriptionDialog(this);
@@ -361,26 +590,78 @@ void MainFrame::OnRecord(wxCommandEvent&) {
     SetStatusText("Listening...");
 }
 
+// -------------------------------------------------------------------
+// Command button → listen for one command, no dialog
+// -------------------------------------------------------------------
+
+void MainFrame::OnVoiceCommand(wxCommandEvent&) {
+    if (m_dlg || m_listeningForCommand) return;
+
+    if (!m_transcriber.StartCommand()) {
+        SetStatusText("Can't listen for a command right now");
+        return;
+    }
+    m_listeningForCommand = true;
+    m_recordBtn->Disable();
+    m_commandBtn->Disable();
+    SetStatusText("Listening for a command...");
+}
+
+void MainFrame::OnCommandResult(wxThreadEvent& evt) {
+    if (!m_listeningForCommand) return;
+    m_listeningForCommand = false;
+
+    // The session has ended on its own; release the capture device.
+    m_transcriber.CancelRecording();
+    m_recordBtn->Enable();
+    m_commandBtn->Enable();
+    m_terminal->SetFocus();
+
+    int index = evt.GetInt();
+    if (index < 0 || index >= static_cast<int>(m_commands.size())) {
+        SetStatusText(evt.GetString().IsEmpty()
+            ? wxString("No command heard")
+            : "Not a command: " + evt.GetString());
+        return;
+    }
+    m_terminal->InjectText(m_commands[index].keys);
+    SetStatusText("Command: " + m_commands[index].phrase);
+}
+
 // -------------------------------------------------------------------
 // Dialog button handlers
 // -------------------------------------------------------------------
 
 void MainFrame::OnDlgStop(wxCommandEvent&) {
-    m_transcriber.StopRecording();
-    // Immediately finalize the dialog with whatever partial text is
-    // currently displayed — no waiting for a final inference pass.
-    if (m_dlg)
+    if (!m_dlg) return;
+    // The final pass is time-boxed by the transcriber; its result
+    // arrives as an is_final event and finalizes the dialog.  If no
+    // final pass will run, finalize with the partial text right away.
+    if (m_transcriber.StopRecording())
+        m_dlg->SetFinalizing();
+    else
         m_dlg->Finalize();
 }
 
 void MainFrame::OnDlgSend(wxCommandEvent&) {
     if (!m_dlg) return;
 
-    // If still recording, cancel — we already have the text from the
-    // dialog, so there's no need for a final transcription pass.
+    // Still recording (or already waiting on the final pass): send the
+    // accurate final text as soon as it arrives.
+    if (!m_dlg->IsFinalized()) {
+        if (m_dlg->IsFinalizing() || m_transcriber.StopRecording()) {
+            m_sendOnFinal = true;
+            m_dlg->SetFinalizing();
+            return;
+        }
+    }
+
+    // The user may have edited the text — send it as shown.
     m_transcriber.CancelRecording();
+    SendText(m_dlg->GetText());
+}
 
-    wxString text = m_dlg->GetText();
+void MainFrame::SendText(const wxString& text) {
     CloseDialog();
     if (!text.IsEmpty()) {
         // Write the text first
@@ -407,6 +688,7 @@ void MainFrame::OnDlgClose(wxCloseEvent& evt) {
 }
 
 void MainFrame::CloseDialog() {
+    m_sendOnFinal = false;
     if (m_dlg) {
         m_dlg->Destroy();
         m_dlg = nullptr;
@@ -425,14 +707,70 @@ void MainFrame::OnFileSelected(wxCommandEvent& evt) {
     m_terminal->SetFocus();
 }
 
+void MainFrame::OnTreeChanged(wxCommandEvent& evt) {
+    // Only what changed is re-read; the glossary follows.
+    m_vocabulary.Invalidate(evt.GetString().ToStdString(wxConvUTF8));
+}
+
 // -------------------------------------------------------------------
 // Transcription events (partial + final)
 // -------------------------------------------------------------------
 
-void MainFrame::OnTranscription(wxThreadEvent& evt) {
-    // Ignore stale events that arrive after the dialog was closed or
-    // after the user clicked Stop (dialog already finalized / editable).
+void MainFrame::OnTranscription(wxThreadEvent&) {
+    for (const auto& update : m_transcripts.TakeAll())
+        ApplyTranscription(update);
+}
+
+void MainFrame::ApplyTranscription(const TranscriptMailbox::Update& update) {
+    auto& latency = m_transcriber.Latency();
+    latency.Mark(update.trace, LatencyMonitor::Delivered);
+
+    // Ignore stale results that arrive after the dialog was closed or
+    // after the final result landed (dialog already finalized / editable).
     if (!m_dlg || m_dlg->IsFinalized()) return;
 
-    m_dlg->UpdateText(evt.GetString());
+    wxString text = wxString::FromUTF8(update.text);
+    m_dlg->UpdateText(text);
+    latency.Mark(update.trace, LatencyMonitor::Displayed);
+    latency.Finish(update.trace);
+    SetStatusText(wxString::FromUTF8(latency.Summary()), 2);
+
+    if (update.isFinal) {
+        if (m_sendOnFinal)
+            SendText(text);
+        else
+            m_dlg->Finalize();
+    }
+}
+
+void MainFrame::OnModelStatus(wxThreadEvent& evt) {
+    auto state = static_cast<Transcriber::ModelState>(evt.GetExtraLong());
+    switch (state) {
+    case Transcriber::ModelState::Loading:
+        m_recordBtn->SetToolTip(wxString::Format(
+            "Loading whisper model (%d%%) \u2014 you can start dictating now", evt.GetInt()));
+        if (!m_dlg)
+            SetStatusText(wxString::Format("Loading whisper model... %d%%", evt.GetInt()));
+        break;
+    case Transcriber::ModelState::Calibrating:
+        if (!m_dlg)
+            SetStatusText(wxString::Format("Calibrating transcription speed... %d%%", evt.GetInt()));
+        break;
+    case Transcriber::ModelState::Ready:
+        m_recordBtn->SetToolTip("Record audio, transcribe, and send to terminal");
+        if (m_transcriber.WasCalibrated())
+            SaveTranscriberSettings();
+        if (!m_dlg)
+            SetStatusText(m_transcriber.WasCalibrated()
+                ? wxString::Format("Ready (%d inference threads)", m_transcriber.ThreadCount())
+                : wxString("Ready"));
+        break;
+    case Transcriber::ModelState::Failed:
+        m_recordBtn->SetToolTip("Voice transcription unavailable");
+        SetStatusText("Whisper model failed to load");
+        wxLogWarning("Could not load whisper model from:\n%s\n\n"
+                     "Voice transcription will be unavailable.",
+                     WHISPER_MODEL_PATH);
+        break;
+    }
 }
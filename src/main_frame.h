@@ -8,7 +8,10 @@
 #include "terminal_panel.h"
 #include "file_tree_panel.h"
 #include "editor_panel.h"
+#include "project_vocabulary.h"
+#include "thread_placement.h"
 #include "transcriber.h"
+#include "transcript_mailbox.h"
 
 // ---------------------------------------------------------------------------
 // Overlay dialog shown during voice transcription
@@ -18,8 +21,10 @@ class TranscriptionDialog : public wxDialog {
 public:
     TranscriptionDialog(wxWindow* parent);
 
-    void UpdateText(const wxString& text);
+    void UpdateText(const wxString& text);    // rewrites only what changed
+    void SetFinalizing();                     // recording stopped — waiting for the final pass
     void Finalize();                          // recording done — let user edit & send
+    bool IsFinalizing() const { return m_finalizing; }
     bool IsFinalized() const { return m_finalized; }
     wxString GetText() const;
 
@@ -28,7 +33,9 @@ private:
     wxStaticText* m_status    = nullptr;
     wxButton*     m_stopBtn   = nullptr;
     wxButton*     m_sendBtn   = nullptr;
-    bool          m_finalized = false;
+    wxString      m_shown;                    // text as last set by UpdateText
+    bool          m_finalizing = false;
+    bool          m_finalized  = false;
 };
 
 // ---------------------------------------------------------------------------
@@ -48,6 +55,9 @@ private:
     void OnOpenFolder(wxCommandEvent& evt);
     void OnOpenRecent(wxCommandEvent& evt);
     void OnClearRecent(wxCommandEvent& evt);
+    void OnRecalibrate(wxCommandEvent& evt);
+    void OnThreadPlacement(wxCommandEvent& evt);
+    void OnDumpLatency(wxCommandEvent& evt);
     void OnQuit(wxCommandEvent& evt);
 
     // Folder management
@@ -57,14 +67,33 @@ private:
     void SaveRecentFolders();
     void RebuildRecentMenu();
 
+    // Thread placement policy (before any thread or child process starts)
+    void ConfigureThreadPlacement();
+
+    // Transcriber settings (calibrated thread count, audio options)
+    void LoadTranscriberSettings();
+    void SaveTranscriberSettings();
+
+    // Voice commands: phrases from [Commands] and the keys each sends
+    struct VoiceCommand {
+        wxString    phrase;
+        std::string keys;
+    };
+    void LoadVoiceCommands();
+
     // Toolbar
     void OnRecord(wxCommandEvent& evt);
+    void OnVoiceCommand(wxCommandEvent& evt);
 
     // File tree
     void OnFileSelected(wxCommandEvent& evt);
+    void OnTreeChanged(wxCommandEvent& evt);
 
     // Transcription events (from background thread → main thread)
     void OnTranscription(wxThreadEvent& evt);
+    void ApplyTranscription(const TranscriptMailbox::Update& update);
+    void OnModelStatus(wxThreadEvent& evt);
+    void OnCommandResult(wxThreadEvent& evt);
 
     // Dialog button handlers
     void OnDlgStop(wxCommandEvent& evt);
@@ -72,15 +101,24 @@ private:
     void OnDlgCancel(wxCommandEvent& evt);
     void OnDlgClose(wxCloseEvent& evt);
     void CloseDialog();
+    void SendText(const wxString& text);
 
     FileTreePanel*  m_fileTree  = nullptr;
     EditorPanel*    m_editor    = nullptr;
     TerminalPanel*  m_terminal  = nullptr;
+    ThreadPlacement m_placement;     // outlives m_transcriber, which points at it
     Transcriber     m_transcriber;
+    TranscriptMailbox m_transcripts;  // transcriber callback → OnTranscription
+    ProjectVocabulary m_vocabulary;   // open folder → m_transcriber's glossary; destroyed first
     wxButton*       m_recordBtn = nullptr;
+    wxButton*       m_commandBtn = nullptr;
+
+    std::vector<VoiceCommand> m_commands;
+    bool                      m_listeningForCommand = false;
 
     TranscriptionDialog* m_dlg = nullptr;
     wxTimer              m_enterTimer;
+    bool                 m_sendOnFinal = false;   // Send pressed while the final pass runs
 
     // Recent folders
     wxMenu*                 m_recentMenu = nullptr;
@@ -88,4 +126,13 @@ private:
     static constexpr int    MAX_RECENT = 10;
     static constexpr int    ID_RECENT_BASE = wxID_HIGHEST + 100;
     static constexpr int    ID_CLEAR_RECENT = wxID_HIGHEST + 200;
+    static constexpr int    ID_RECALIBRATE  = wxID_HIGHEST + 201;
+    static constexpr int    ID_THREAD_PLACEMENT = wxID_HIGHEST + 202;
+    static constexpr int    ID_DUMP_LATENCY     = wxID_HIGHEST + 203;
+    static constexpr int    ID_VOICE_COMMAND    = wxID_HIGHEST + 204;
+
+    // Background-thread event ids
+    static constexpr int    ID_TRANSCRIPTION = wxID_HIGHEST + 300;
+    static constexpr int    ID_MODEL_STATUS  = wxID_HIGHEST + 301;
+    static constexpr int    ID_COMMAND_RESULT = wxID_HIGHEST + 302;
 };
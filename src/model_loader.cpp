@@ -0,0 +1,90 @@
+#include "model_loader.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+ModelFileLoader::ModelFileLoader(const std::string& path,
+                                 std::function<void(int)> onProgress)
+    : m_onProgress(std::move(onProgress))
+{
+    m_loader.context = this;
+    m_loader.read    = &ModelFileLoader::Read;
+    m_loader.eof     = &ModelFileLoader::Eof;
+    m_loader.close   = &ModelFileLoader::Close;
+
+    m_fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (m_fd < 0) return;
+
+    struct stat st;
+    if (::fstat(m_fd, &st) != 0) {
+        Release();
+        return;
+    }
+    m_size = static_cast<size_t>(st.st_size);
+
+    // Shared read-only mapping: pages come from the page cache and are
+    // shared with every other process that has the model open.
+    void* p = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, m_fd, 0);
+    if (p != MAP_FAILED) {
+        m_map = static_cast<const unsigned char*>(p);
+        ::madvise(p, m_size, MADV_SEQUENTIAL);
+        ::madvise(p, m_size, MADV_WILLNEED);
+    }
+}
+
+ModelFileLoader::~ModelFileLoader() {
+    Release();
+}
+
+void ModelFileLoader::Release() {
+    if (m_map) {
+        ::munmap(const_cast<unsigned char*>(m_map), m_size);
+        m_map = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+}
+
+void ModelFileLoader::ReportProgress() {
+    int pct = m_size ? static_cast<int>(m_offset * 100 / m_size) : 0;
+    if (pct != m_percent) {
+        m_percent = pct;
+        if (m_onProgress) m_onProgress(pct);
+    }
+}
+
+size_t ModelFileLoader::Read(void* ctx, void* output, size_t readSize) {
+    auto* self = static_cast<ModelFileLoader*>(ctx);
+    size_t n = 0;
+
+    if (self->m_map) {
+        n = std::min(readSize, self->m_size - self->m_offset);
+        std::memcpy(output, self->m_map + self->m_offset, n);
+    } else if (self->m_fd >= 0) {
+        auto* out = static_cast<char*>(output);
+        while (n < readSize) {
+            ssize_t got = ::read(self->m_fd, out + n, readSize - n);
+            if (got <= 0) break;
+            n += static_cast<size_t>(got);
+        }
+    }
+
+    self->m_offset += n;
+    self->ReportProgress();
+    return n;
+}
+
+bool ModelFileLoader::Eof(void* ctx) {
+    auto* self = static_cast<ModelFileLoader*>(ctx);
+    return self->m_fd < 0 || self->m_offset >= self->m_size;
+}
+
+void ModelFileLoader::Close(void* ctx) {
+    static_cast<ModelFileLoader*>(ctx)->Release();
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <whisper.h>
+
+#include <cstddef>
+#include <functional>
+#include <string>
+
+/// whisper_model_loader backed by an mmap of the model file.
+///
+/// whisper copies every tensor out of the loader into its own buffers,
+/// so mapping the file doesn't make the weights themselves shared.  It
+/// does serve the reads straight from the page cache, with no per-read
+/// syscalls and no stdio buffer copy.  On a warm cache, which is the
+/// normal case when several instances use the same model, loading
+/// becomes a memcpy.  Falls back to read() if the file can't be mapped.
+class ModelFileLoader {
+public:
+    /// @param onProgress  Called with 0..100 as the file is consumed.
+    ModelFileLoader(const std::string& path, std::function<void(int)> onProgress);
+    ~ModelFileLoader();
+
+    ModelFileLoader(const ModelFileLoader&) = delete;
+    ModelFileLoader& operator=(const ModelFileLoader&) = delete;
+
+    bool IsOpen() const { return m_fd >= 0; }
+
+    /// Pass to whisper_init_with_params().  whisper calls close() on it
+    /// when done; the destructor cleans up if it didn't.
+    whisper_model_loader* Loader() { return &m_loader; }
+
+private:
+    static size_t Read(void* ctx, void* output, size_t readSize);
+    static bool   Eof(void* ctx);
+    static void   Close(void* ctx);
+
+    void Release();
+    void ReportProgress();
+
+    int                      m_fd      = -1;
+    const unsigned char*     m_map     = nullptr;   // null → read() fallback
+    size_t                   m_size    = 0;
+    size_t                   m_offset  = 0;
+    int                      m_percent = -1;
+    std::function<void(int)> m_onProgress;
+    whisper_model_loader     m_loader  = {};
+};
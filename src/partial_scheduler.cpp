@@ -0,0 +1,38 @@
+#include "partial_scheduler.h"
+
+#include <whisper.h>
+#include <algorithm>
+
+static constexpr double MIN_STEP_SEC = 0.2;   // never decode more often than this
+static constexpr double MAX_STEP_SEC = 2.0;   // never leave the preview stale longer
+static constexpr double MAX_DUTY     = 0.75;  // max share of wall time spent in inference
+static constexpr double SMOOTHING    = 0.3;   // EMA weight of the newest pass
+
+void PartialScheduler::RecordPass(double seconds, size_t audioSamples) {
+    double audioSec = static_cast<double>(audioSamples) / WHISPER_SAMPLE_RATE;
+    double rtf = audioSec > 0.0 ? seconds / audioSec : 0.0;
+
+    if (!m_primed) {
+        m_rtf    = rtf;
+        m_primed = true;
+        return;
+    }
+    m_rtf += (rtf - m_rtf) * SMOOTHING;
+}
+
+size_t PartialScheduler::StepSamples(size_t windowSamples) const {
+    // Wait for at least as much new audio as the next pass will take to
+    // decode (scaled by MAX_DUTY).  That pass covers the window plus the
+    // step, so with step = rtf * (window + step) / MAX_DUTY:
+    //   step = rtf * window / (MAX_DUTY - rtf)
+    // A pass that takes 900 ms then runs every ~1.2 s instead of
+    // back-to-back on a fixed 400 ms timer, and the step grows with the
+    // window instead of lagging one pass behind it.
+    double step = MAX_STEP_SEC;
+    if (!m_primed)
+        step = MIN_STEP_SEC;
+    else if (m_rtf < MAX_DUTY)
+        step = m_rtf * (static_cast<double>(windowSamples) / WHISPER_SAMPLE_RATE) / (MAX_DUTY - m_rtf);
+    step = std::clamp(step, MIN_STEP_SEC, MAX_STEP_SEC);
+    return static_cast<size_t>(step * WHISPER_SAMPLE_RATE);
+}
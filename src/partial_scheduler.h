@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+
+/// Decides how much new audio should accumulate before the next partial
+/// pass, based on the real-time factor of recent passes.
+///
+/// Fast machines get partials as often as MIN_STEP allows; when
+/// inference slows down (bigger model, busy CPU, a longer window) the
+/// step grows so the streaming thread never queues up passes over audio
+/// that's already stale by the time they finish.
+class PartialScheduler {
+public:
+    /// Record a finished pass: wall-clock seconds and samples decoded.
+    void RecordPass(double seconds, size_t audioSamples);
+
+    /// New samples that should be captured before the next pass, which
+    /// will decode @p windowSamples plus that step.
+    size_t StepSamples(size_t windowSamples) const;
+
+private:
+    double m_rtf    = 0.0;     // smoothed inference time per second of audio
+    bool   m_primed = false;
+};
@@ -0,0 +1,352 @@
+#include "project_vocabulary.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <unordered_map>
+
+namespace fs = std::filesystem;
+
+static constexpr size_t MAX_FILES      = 20000;       // stop walking huge trees here
+static constexpr size_t MAX_FILE_BYTES = 256 * 1024;  // only the head of bigger sources is read
+static constexpr size_t MAX_TERMS      = 300;         // handed to the listener
+static constexpr size_t NAME_TERMS     = 100;         // of those, kept for file and type names
+static constexpr size_t MIN_TERM_CHARS = 3;
+
+static const std::set<std::string> SOURCE_EXTENSIONS = {
+    ".c", ".cc", ".cpp", ".cxx", ".h", ".hh", ".hpp", ".hxx", ".m", ".mm",
+    ".py", ".js", ".jsx", ".ts", ".tsx", ".go", ".rs", ".java", ".kt",
+    ".swift", ".cs", ".rb", ".php", ".lua", ".zig",
+};
+
+/// Keywords whose next identifier is a type the file defines.
+static const std::set<std::string> TYPE_KEYWORDS = {
+    "class", "struct", "enum", "union", "interface", "trait", "type", "typedef",
+};
+
+/// ... or some other name it defines.
+static const std::set<std::string> DEFINING_KEYWORDS = {
+    "class", "struct", "enum", "union", "namespace", "interface", "trait",
+    "type", "typedef", "def", "fn", "func", "function", "define", "module",
+};
+
+/// Generated, vendored or hidden folders nobody dictates about.
+static bool skippedDir(const std::string& name) {
+    static const std::set<std::string> names = {
+        "node_modules", "__pycache__", "target", "dist", "vendor", "third_party",
+    };
+    return name.empty() || name[0] == '.' || name[0] == '_'
+        || names.count(name) || name.rfind("build", 0) == 0
+        || name.rfind("cmake-build", 0) == 0;
+}
+
+static bool isIdentStart(char c) {
+    return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+}
+
+static bool isIdentChar(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+/// An identifier whisper wouldn't write by itself: snake_case,
+/// camelCase/PascalCase humps or digits.  Plain words it already spells.
+static bool distinctive(const std::string& word) {
+    for (size_t i = 1; i < word.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(word[i]);
+        if (c == '_' || std::isdigit(c) || std::isupper(c)) return true;
+    }
+    return false;
+}
+
+struct SourceTerms {
+    std::set<std::string> names;      // types defined
+    std::set<std::string> terms;      // other names defined, modules imported
+    std::set<std::string> includes;   // "quoted" #include paths, as written
+};
+
+/// Names @p text defines (after a defining keyword, or Class::member
+/// definitions) and the modules it pulls in.
+static void sourceTerms(const std::string& text, SourceTerms& out) {
+    auto add = [&](std::set<std::string>& to, const std::string& term) {
+        if (term.size() >= MIN_TERM_CHARS) to.insert(term);
+    };
+
+    // Imports: a quoted #include (<...> ones are the system's or another
+    // project's), the first part of a module.
+    size_t lineStart = 0;
+    while (lineStart < text.size()) {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos) lineEnd = text.size();
+        std::string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        size_t p = line.find_first_not_of(" \t");
+        if (p == std::string::npos) continue;
+        if (line.compare(p, 8, "#include") == 0) {
+            size_t open = line.find_first_not_of(" \t", p + 8);
+            if (open == std::string::npos || line[open] != '"') continue;
+            size_t close = line.find('"', open + 1);
+            if (close == std::string::npos) continue;
+            out.includes.insert(line.substr(open + 1, close - open - 1));
+        } else if (line.compare(p, 7, "import ") == 0 || line.compare(p, 5, "from ") == 0
+                   || line.compare(p, 4, "use ") == 0) {
+            p = line.find(' ', p) + 1;
+            p = line.find_first_not_of(" \t\"'", p);
+            if (p == std::string::npos || !isIdentStart(line[p])) continue;
+            size_t e = p;
+            while (e < line.size() && isIdentChar(line[e])) ++e;
+            add(out.terms, line.substr(p, e - p));
+        }
+    }
+
+    // Definitions.
+    std::string prev;
+    for (size_t i = 0; i < text.size(); ) {
+        if (!isIdentStart(text[i])) {
+            if (!std::isspace(static_cast<unsigned char>(text[i])) && text[i] != '#'
+                && text.compare(i, 2, "::") != 0)
+                prev.clear();
+            i += text.compare(i, 2, "::") == 0 ? 2 : 1;
+            continue;
+        }
+        size_t e = i;
+        while (e < text.size() && isIdentChar(text[e])) ++e;
+        std::string word = text.substr(i, e - i);
+
+        if (DEFINING_KEYWORDS.count(prev) && !DEFINING_KEYWORDS.count(word) && distinctive(word))
+            add(TYPE_KEYWORDS.count(prev) ? out.names : out.terms, word);
+        // FooBar::baz_qux — a member of one of the project's own types.
+        if (i >= 2 && text.compare(i - 2, 2, "::") == 0 && distinctive(prev)
+            && std::isupper(static_cast<unsigned char>(prev[0])))
+        {
+            add(out.names, prev);
+            if (distinctive(word)) add(out.terms, word);
+        }
+        prev = word;
+        i = e;
+    }
+}
+
+static void fileTerms(const fs::path& file, SourceTerms& out) {
+    std::string name = file.filename().string();
+    if (name.size() >= MIN_TERM_CHARS) out.names.insert(name);
+
+    if (SOURCE_EXTENSIONS.count(file.extension().string())) {
+        std::ifstream in(file, std::ios::binary);
+        std::string text(MAX_FILE_BYTES, '\0');
+        in.read(&text[0], static_cast<std::streamsize>(text.size()));
+        text.resize(static_cast<size_t>(in.gcount()));
+        sourceTerms(text, out);
+    }
+}
+
+// ============================================================================
+
+ProjectVocabulary::ProjectVocabulary()
+    : m_thread([this] { Run(); })
+{}
+
+ProjectVocabulary::~ProjectVocabulary() {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_stop = true;
+    }
+    m_cv.notify_all();
+    m_thread.join();
+}
+
+void ProjectVocabulary::SetListener(Listener listener) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    m_listener = std::move(listener);
+}
+
+void ProjectVocabulary::SetRoot(const std::string& dir) {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_root = dir;
+        m_pending.clear();
+        ++m_generation;
+    }
+    m_cv.notify_all();
+}
+
+void ProjectVocabulary::Invalidate(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        if (std::find(m_pending.begin(), m_pending.end(), path) == m_pending.end())
+            m_pending.push_back(path);
+    }
+    m_cv.notify_all();
+}
+
+std::vector<std::string> ProjectVocabulary::Terms() const {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    return m_terms;
+}
+
+void ProjectVocabulary::Run() {
+    for (;;) {
+        std::unique_lock<std::mutex> lk(m_mutex);
+        m_cv.wait(lk, [this] {
+            return m_stop || m_generation != m_scanGeneration || !m_pending.empty();
+        });
+        if (m_stop) return;
+
+        bool changed;
+        if (m_generation != m_scanGeneration) {
+            // New project: start over.
+            m_scanGeneration = m_generation;
+            m_scanRoot       = m_root;
+            lk.unlock();
+            m_files.clear();
+            Rescan(m_scanRoot);
+            changed = true;
+        } else {
+            fs::path path = m_pending.front();
+            m_pending.pop_front();
+            lk.unlock();
+            changed = Rescan(path);
+        }
+        if (changed && !Interrupted())
+            Publish();
+    }
+}
+
+bool ProjectVocabulary::Rescan(const fs::path& path) {
+    if (m_scanRoot.empty()) return false;
+
+    // Only paths inside the project.
+    std::string root = m_scanRoot.lexically_normal().string();
+    std::string key  = path.lexically_normal().string();
+    while (key.size() > 1 && key.back() == '/') key.pop_back();
+    while (root.size() > 1 && root.back() == '/') root.pop_back();
+    if (key.compare(0, root.size(), root) != 0
+        || (key.size() > root.size() && key[root.size()] != '/'))
+        return false;
+
+    bool changed = false;
+    std::set<std::string> seen;
+    auto visit = [&](const fs::path& file) {
+        std::error_code ec;
+        auto mtime = fs::last_write_time(file, ec);
+        if (ec) return;
+        std::string name = file.string();
+        seen.insert(name);
+        auto it = m_files.find(name);
+        if (it != m_files.end() && it->second.mtime == mtime) return;
+        if (it == m_files.end() && m_files.size() >= MAX_FILES) return;
+        SourceTerms found;
+        fileTerms(file, found);
+        m_files[name] = {mtime,
+                         {found.names.begin(), found.names.end()},
+                         {found.terms.begin(), found.terms.end()},
+                         {found.includes.begin(), found.includes.end()}};
+        changed = true;
+    };
+
+    std::error_code ec;
+    if (fs::is_directory(key, ec)) {
+        fs::recursive_directory_iterator it(key, fs::directory_options::skip_permission_denied, ec);
+        for (; !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (Interrupted()) return false;
+            std::error_code typeEc;
+            if (it->is_directory(typeEc)) {
+                if (skippedDir(it->path().filename().string()))
+                    it.disable_recursion_pending();
+            } else if (it->is_regular_file(typeEc)) {
+                visit(it->path());
+            }
+        }
+    } else if (fs::is_regular_file(key, ec)) {
+        visit(key);
+    }
+
+    // Whatever was below the path and wasn't seen again is gone.
+    for (auto it = m_files.lower_bound(key); it != m_files.end(); ) {
+        const std::string& name = it->first;
+        if (name.compare(0, key.size(), key) != 0) break;
+        bool below = name.size() == key.size() || name[key.size()] == '/';
+        if (below && !seen.count(name)) {
+            it = m_files.erase(it);
+            changed = true;
+        } else {
+            ++it;
+        }
+    }
+    return changed;
+}
+
+bool ProjectVocabulary::Resolves(const std::string& includer, const std::string& header,
+                                 const FileIndex& byName) const
+{
+    // Next to the including file, or below some include directory of
+    // the tree: any file whose path ends in the one written.
+    fs::path written = fs::path(header).lexically_normal();
+    if (m_files.count((fs::path(includer).parent_path() / written).lexically_normal().string()))
+        return true;
+    auto it = byName.find(written.filename().string());
+    if (it == byName.end()) return false;
+    const std::string suffix = "/" + written.string();
+    for (const std::string* path : it->second)
+        if (path->size() > suffix.size()
+            && path->compare(path->size() - suffix.size(), suffix.size(), suffix) == 0)
+            return true;
+    return false;
+}
+
+void ProjectVocabulary::Publish() {
+    // Rank by how many files use a term: a type used everywhere matters
+    // more than a helper defined once.  An include only counts when it
+    // is one of the tree's own headers.
+    FileIndex byName;
+    for (const auto& [path, file] : m_files)
+        byName[fs::path(path).filename().string()].push_back(&path);
+
+    std::unordered_map<std::string, int> uses;
+    std::set<std::string>                names;
+    for (const auto& [path, file] : m_files) {
+        for (const auto& term : file.names) {
+            ++uses[term];
+            names.insert(term);
+        }
+        for (const auto& term : file.terms)
+            ++uses[term];
+        std::set<std::string> stems;
+        for (const auto& header : file.includes) {
+            std::string stem = fs::path(header).stem().string();
+            if (stem.size() >= MIN_TERM_CHARS && Resolves(path, header, byName))
+                stems.insert(stem);
+        }
+        for (const auto& stem : stems)
+            ++uses[stem];
+    }
+
+    std::vector<std::pair<std::string, int>> ranked(uses.begin(), uses.end());
+    std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) {
+        return a.second != b.second ? a.second > b.second : a.first < b.first;
+    });
+
+    // File and type names are what gets said most and spelled worst, and
+    // a few helpers used in every file would otherwise crowd them out:
+    // they get the first NAME_TERMS places, the rest go by use.
+    std::vector<std::string> terms;
+    std::vector<bool>        taken(ranked.size(), false);
+    for (size_t i = 0; i < ranked.size() && terms.size() < NAME_TERMS; ++i)
+        if (names.count(ranked[i].first)) {
+            terms.push_back(ranked[i].first);
+            taken[i] = true;
+        }
+    for (size_t i = 0; i < ranked.size() && terms.size() < MAX_TERMS; ++i)
+        if (!taken[i])
+            terms.push_back(ranked[i].first);
+
+    Listener listener;
+    {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        m_terms  = terms;
+        listener = m_listener;
+    }
+    if (listener)
+        listener(terms);
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/// Words someone working in a project is likely to say that whisper
+/// won't spell right unprompted: its file names, the names its source
+/// files define (classes, functions, types) and the headers/modules
+/// they pull in.
+///
+/// A background thread walks the folder and reads the source files.
+/// What each file contributed is kept with its modification time, so
+/// Invalidate() on a changed path only re-reads the files that actually
+/// changed below it.  After every update the listener gets the terms:
+/// file and type names first, then the rest, each most widely used
+/// first.  Knows nothing about wxWidgets.
+class ProjectVocabulary {
+public:
+    using Listener = std::function<void(const std::vector<std::string>& terms)>;
+
+    ProjectVocabulary();
+    ~ProjectVocabulary();
+
+    ProjectVocabulary(const ProjectVocabulary&) = delete;
+    ProjectVocabulary& operator=(const ProjectVocabulary&) = delete;
+
+    /// Called on the scan thread after each update.  Set before SetRoot().
+    void SetListener(Listener listener);
+
+    /// Forget the previous project and scan @p dir.
+    void SetRoot(const std::string& dir);
+
+    /// @p path (a file or a folder) was created, changed or removed:
+    /// rescan what's below it.
+    void Invalidate(const std::string& path);
+
+    /// The current terms, in the listener's order.
+    std::vector<std::string> Terms() const;
+
+private:
+    struct FileTerms {
+        std::filesystem::file_time_type mtime;
+        std::vector<std::string>        names;      // its file name, types it defines
+        std::vector<std::string>        terms;      // other names, modules it imports
+        std::vector<std::string>        includes;   // "quoted" #includes, as written
+    };
+
+    /// File name → paths in m_files with that name.
+    using FileIndex = std::map<std::string, std::vector<const std::string*>>;
+
+    void Run();
+
+    /// Bring m_files up to date for everything at or below @p path.
+    /// Returns true if anything changed.
+    bool Rescan(const std::filesystem::path& path);
+
+    /// True if @p header, #included by @p includer, is a file of the tree.
+    bool Resolves(const std::string& includer, const std::string& header,
+                  const FileIndex& byName) const;
+
+    /// Rank the terms of m_files and hand them to the listener.
+    void Publish();
+
+    /// A newer root or shutdown makes the scan in progress pointless.
+    bool Interrupted() const { return m_stop || m_generation != m_scanGeneration; }
+
+    // Scan thread only.
+    std::filesystem::path            m_scanRoot;
+    uint64_t                         m_scanGeneration = 0;
+    std::map<std::string, FileTerms> m_files;      // path → what it contributes
+
+    mutable std::mutex        m_mutex;
+    std::condition_variable   m_cv;
+    std::string               m_root;              // requested root
+    std::atomic<uint64_t>     m_generation{0};     // bumped by SetRoot()
+    std::deque<std::string>   m_pending;           // invalidated paths
+    std::vector<std::string>  m_terms;
+    Listener                  m_listener;
+    std::atomic<bool>         m_stop{false};
+    std::thread               m_thread;
+};
@@ -0,0 +1,122 @@
+// Checks ProjectVocabulary's ranking over a small fixture tree.
+//
+// The tree is written to a temporary folder: a few C++ files whose
+// "quoted" includes resolve (or don't) to files of the tree, and enough
+// Python helpers, each imported by three files, to fill the whole term
+// budget on use counts alone.  File and type names must still come
+// first, and only includes that name one of the tree's own files may
+// count.
+//
+//   whisper-agent-vocabulary-test
+
+#include "project_vocabulary.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static constexpr int HELPERS    = 400;     // more than the listener's budget
+static constexpr int IMPORTERS  = 3;       // files importing each helper
+static constexpr int TIMEOUT_MS = 20000;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+static void write(const fs::path& path, const std::string& text) {
+    fs::create_directories(path.parent_path());
+    std::ofstream(path) << text;
+}
+
+static void makeFixture(const fs::path& root) {
+    write(root / "include/engine/audio_engine.h",
+          "#pragma once\n"
+          "class AudioEngine {\n"
+          "public:\n"
+          "    void Start();\n"
+          "};\n");
+
+    // Every source includes the header (through the include folder, or
+    // relative to itself), a header the tree doesn't have, and an
+    // <angle> one: each used by more files than any helper.
+    const char* sources[] = {"audio_engine.cpp", "mixer.cpp", "device.cpp", "main.cpp"};
+    for (const char* name : sources) {
+        bool relative = std::string(name) == "main.cpp";
+        write(root / "src" / name,
+              std::string(relative ? "#include \"../include/engine/audio_engine.h\"\n"
+                                   : "#include \"engine/audio_engine.h\"\n")
+              + "#include \"missing_config.h\"\n"
+                "#include <external_lib.h>\n"
+                "#include <vector>\n"
+              + (std::string(name) == "audio_engine.cpp" ? "void AudioEngine::Start() {}\n" : ""));
+    }
+
+    for (int i = 0; i < IMPORTERS; ++i) {
+        std::string text;
+        for (int h = 0; h < HELPERS; ++h)
+            text += "import alpha_helper_" + std::to_string(h) + "\n";   // sorts first on a tie
+        write(root / ("scripts/user_" + std::to_string(i) + ".py"), text);
+    }
+}
+
+static int indexOf(const std::vector<std::string>& terms, const std::string& term) {
+    auto it = std::find(terms.begin(), terms.end(), term);
+    return it == terms.end() ? -1 : static_cast<int>(it - terms.begin());
+}
+
+int main() {
+    const fs::path root = fs::temp_directory_path()
+                        / ("whisper-agent-vocabulary-" + std::to_string(
+                               std::chrono::steady_clock::now().time_since_epoch().count()));
+    makeFixture(root);
+
+    std::mutex               mtx;
+    std::condition_variable  cv;
+    std::vector<std::string> terms;
+    bool                     published = false;
+    {
+        ProjectVocabulary vocabulary;
+        vocabulary.SetListener([&](const std::vector<std::string>& t) {
+            std::lock_guard<std::mutex> lk(mtx);
+            terms     = t;
+            published = true;
+            cv.notify_all();
+        });
+        vocabulary.SetRoot(root.string());
+
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait_for(lk, std::chrono::milliseconds(TIMEOUT_MS), [&] { return published; });
+    }
+    fs::remove_all(root);
+
+    check(published, "the scan publishes");
+    check(terms.size() == 300, "the budget is filled");
+
+    int type    = indexOf(terms, "AudioEngine");
+    int file    = indexOf(terms, "audio_engine.cpp");
+    int helper  = indexOf(terms, "alpha_helper_0");
+    check(type >= 0 && file >= 0, "file and type names are kept");
+    check(helper >= 0 && type < helper && file < helper,
+          "names rank ahead of more widely used identifiers");
+
+    // Used by four files, so it outranks every helper — if all four
+    // includes resolve, through the include folder or relative to main.cpp.
+    int stem = indexOf(terms, "audio_engine");
+    check(stem >= 0 && stem < helper, "a quoted include of the tree's own header counts");
+    check(indexOf(terms, "missing_config") < 0, "an include that isn't in the tree doesn't");
+    check(indexOf(terms, "external_lib") < 0 && indexOf(terms, "vector") < 0,
+          "<angle> includes don't");
+
+    return failures ? 1 : 0;
+}
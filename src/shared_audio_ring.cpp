@@ -0,0 +1,142 @@
+#include "shared_audio_ring.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <algorithm>
+#include <cstring>
+#include <new>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the shared write position must be lock-free to work across processes");
+
+static size_t roundUpPow2(size_t n) {
+    size_t p = 1;
+    while (p < n) p <<= 1;
+    return p;
+}
+
+std::unique_ptr<SharedAudioRing> SharedAudioRing::Create(size_t capacity) {
+    capacity = roundUpPow2(std::max<size_t>(capacity, 2));
+    const size_t bytes = DATA_OFFSET + capacity * sizeof(float);
+
+    int fd = memfd_create("whisper-agent-audio", MFD_CLOEXEC);
+    if (fd < 0) return nullptr;
+    if (ftruncate(fd, static_cast<off_t>(bytes)) != 0) {
+        close(fd);
+        return nullptr;
+    }
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return nullptr;
+    }
+
+    // A fresh memfd is zero-filled, which is already a valid empty ring;
+    // the placement new just makes the atomic's lifetime official.
+    auto* header = new (base) Header;
+    header->writePos.store(0, std::memory_order_relaxed);
+    header->reservePos.store(0, std::memory_order_relaxed);
+    header->capacity = capacity;
+    return std::unique_ptr<SharedAudioRing>(new SharedAudioRing(fd, base, bytes));
+}
+
+std::unique_ptr<SharedAudioRing> SharedAudioRing::Map(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= DATA_OFFSET)
+        return nullptr;
+    const size_t bytes = static_cast<size_t>(st.st_size);
+    void* base = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED)
+        return nullptr;
+
+    auto* header = static_cast<Header*>(base);
+    size_t capacity = static_cast<size_t>(header->capacity);
+    if (capacity < 2 || (capacity & (capacity - 1)) != 0
+        || DATA_OFFSET + capacity * sizeof(float) > bytes)
+    {
+        munmap(base, bytes);
+        return nullptr;
+    }
+    return std::unique_ptr<SharedAudioRing>(new SharedAudioRing(fd, base, bytes));
+}
+
+SharedAudioRing::SharedAudioRing(int fd, void* base, size_t bytes)
+    : m_fd(fd)
+    , m_base(base)
+    , m_bytes(bytes)
+    , m_mask(static_cast<Header*>(base)->capacity - 1)
+    , m_header(static_cast<Header*>(base))
+    , m_data(reinterpret_cast<float*>(static_cast<char*>(base) + DATA_OFFSET))
+{}
+
+SharedAudioRing::~SharedAudioRing() {
+    munmap(m_base, m_bytes);
+    close(m_fd);
+}
+
+void SharedAudioRing::Write(const float* data, size_t count) {
+    // A write larger than the ring only leaves its tail readable.
+    if (count > Capacity()) {
+        data  += count - Capacity();
+        count  = Capacity();
+    }
+    const uint64_t w = m_header->writePos.load(std::memory_order_relaxed);
+
+    // Announce the write before touching the data: the fence keeps the
+    // copy below from becoming visible ahead of reservePos.
+    m_header->reservePos.store(w + count, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    // Copy in at most two contiguous spans (wrap-around).
+    size_t idx   = static_cast<size_t>(w) & m_mask;
+    size_t first = std::min(count, Capacity() - idx);
+    std::memcpy(m_data + idx, data, first * sizeof(float));
+    if (count > first)
+        std::memcpy(m_data, data + first, (count - first) * sizeof(float));
+
+    m_header->writePos.store(w + count, std::memory_order_release);
+}
+
+uint64_t SharedAudioRing::WritePosition() const {
+    return m_header->writePos.load(std::memory_order_acquire);
+}
+
+size_t SharedAudioRing::Read(uint64_t& pos, float* out, size_t maxCount, size_t align,
+                             uint64_t& dropped) const
+{
+    align = std::max<size_t>(align, 1);
+    auto skipOverwritten = [&](uint64_t w) {
+        if (w - pos <= Capacity()) return;
+        uint64_t skip = w - Capacity() - pos;
+        skip += (align - skip % align) % align;
+        pos     += skip;
+        dropped += skip;
+    };
+
+    const uint64_t w = WritePosition();
+    skipOverwritten(w);
+    size_t n = static_cast<size_t>(std::min<uint64_t>(maxCount, w - pos));
+    n -= n % align;
+    if (n == 0) return 0;
+
+    size_t idx   = static_cast<size_t>(pos) & m_mask;
+    size_t first = std::min(n, Capacity() - idx);
+    std::memcpy(out, m_data + idx, first * sizeof(float));
+    if (n > first)
+        std::memcpy(out + first, m_data, (n - first) * sizeof(float));
+
+    // The producer may have lapped us while we copied, possibly with a
+    // write still in progress; then the start of the copy is garbage.
+    // The fence orders the copy before the check, and any write that
+    // reached our samples had announced itself before touching them.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const uint64_t reserved = m_header->reservePos.load(std::memory_order_relaxed);
+    if (reserved - pos > Capacity()) {
+        skipOverwritten(reserved);
+        return 0;
+    }
+    pos += n;
+    return n;
+}
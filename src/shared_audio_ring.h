@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/// Single-producer / single-consumer ring of audio samples in shared
+/// memory (an anonymous memfd a child inherits), so a capture callback
+/// in one process can feed a reader in another.  Linux only.
+///
+/// Write() never waits for the reader.  A reader that falls a whole ring
+/// behind, or finds (seqlock-style) that a write overtook its copy,
+/// skips ahead and counts the gap as dropped.  Positions are absolute
+/// sample indices since Create().
+class SharedAudioRing {
+public:
+    /// Allocate a new segment of at least @p capacity samples (rounded up
+    /// to a power of two).  Returns nullptr on failure.
+    static std::unique_ptr<SharedAudioRing> Create(size_t capacity);
+
+    /// Map a segment created by another process, given its descriptor.
+    /// Returns nullptr if @p fd isn't one.
+    static std::unique_ptr<SharedAudioRing> Map(int fd);
+
+    ~SharedAudioRing();
+
+    SharedAudioRing(const SharedAudioRing&) = delete;
+    SharedAudioRing& operator=(const SharedAudioRing&) = delete;
+
+    /// The segment's descriptor (close-on-exec; dup2 it into a child).
+    int Fd() const { return m_fd; }
+
+    size_t Capacity() const { return m_mask + 1; }
+
+    /// Producer side: append @p count samples.  Never blocks or allocates.
+    void Write(const float* data, size_t count);
+
+    /// Absolute index of the next sample the producer will write.
+    uint64_t WritePosition() const;
+
+    /// Consumer side: copy up to @p maxCount samples from @p pos on into
+    /// @p out and advance @p pos.  Samples already overwritten are
+    /// skipped (in whole multiples of @p align, e.g. the channel count)
+    /// and added to @p dropped.  Returns the number of samples copied.
+    size_t Read(uint64_t& pos, float* out, size_t maxCount, size_t align,
+                uint64_t& dropped) const;
+
+private:
+    struct Header {
+        std::atomic<uint64_t> writePos;     // samples before it are complete
+        uint64_t              capacity;
+        std::atomic<uint64_t> reservePos;   // samples before it may be being written
+    };
+    static constexpr size_t DATA_OFFSET = 64;   // header padded to a cache line
+
+    SharedAudioRing(int fd, void* base, size_t bytes);
+
+    int     m_fd    = -1;
+    void*   m_base  = nullptr;
+    size_t  m_bytes = 0;
+    size_t  m_mask  = 0;
+    Header* m_header = nullptr;
+    float*  m_data   = nullptr;
+};
@@ -0,0 +1,180 @@
+#include "thread_placement.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+static constexpr int AUDIO_RT_PRIORITY = 10;   // SCHED_FIFO; low, but above every normal thread
+static constexpr int MIN_PHYSICAL_CORES = 2;    // fewer → nothing to separate
+
+#ifdef __linux__
+static const char* roleName(ThreadRole role) {
+    switch (role) {
+    case ThreadRole::Ui:        return "UI";
+    case ThreadRole::Audio:     return "Audio";
+    case ThreadRole::Inference: return "Inference";
+    }
+    return "?";
+}
+
+static std::string cpuList(const std::vector<int>& cpus) {
+    std::string out;
+    for (int c : cpus) {
+        if (!out.empty()) out += ',';
+        out += std::to_string(c);
+    }
+    return out.empty() ? "any" : out;
+}
+
+static int readSysInt(int cpu, const char* leaf) {
+    char path[128];
+    std::snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/%s", cpu, leaf);
+    FILE* f = std::fopen(path, "r");
+    if (!f) return -1;
+    int v = -1;
+    if (std::fscanf(f, "%d", &v) != 1) v = -1;
+    std::fclose(f);
+    return v;
+}
+
+static int pinTo(const std::vector<int>& cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) CPU_SET(c, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+#endif
+
+void ThreadPlacement::Configure(const Policy& policy) {
+    m_policy = policy;
+    m_processCpus.clear();
+    m_inferenceCpus.clear();
+    m_uiCpus.clear();
+    m_physicalCores = 0;
+
+#ifdef __linux__
+    if (!policy.cpus.empty())
+        pinTo(policy.cpus);
+
+    // Logical CPUs this process may use, grouped by physical core.
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return;
+
+    std::map<std::pair<int, int>, std::vector<int>> cores;   // (package, core) → CPUs
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (!CPU_ISSET(cpu, &allowed)) continue;
+        m_processCpus.push_back(cpu);
+        int pkg  = readSysInt(cpu, "physical_package_id");
+        int core = readSysInt(cpu, "core_id");
+        if (core < 0) core = cpu;   // no topology info: treat each CPU as a core
+        cores[{pkg, core}].push_back(cpu);
+    }
+    m_physicalCores = static_cast<int>(cores.size());
+
+    if (!policy.enabled || m_physicalCores < MIN_PHYSICAL_CORES) return;
+
+    // Leave at least one physical core (a quarter on big machines) for
+    // the UI, the audio thread and whatever runs in the terminal.
+    int n = policy.inferenceCores > 0
+          ? std::min(policy.inferenceCores, m_physicalCores - 1)
+          : m_physicalCores - std::max(1, m_physicalCores / 4);
+
+    // Inference takes the highest-numbered cores — core 0 tends to
+    // handle most interrupts — and one SMT sibling of each.
+    int i = 0;
+    for (const auto& [key, cpus] : cores) {
+        if (i++ < m_physicalCores - n)
+            m_uiCpus.insert(m_uiCpus.end(), cpus.begin(), cpus.end());
+        else
+            m_inferenceCpus.push_back(cpus.front());
+    }
+    std::sort(m_uiCpus.begin(), m_uiCpus.end());
+#endif
+}
+
+void ThreadPlacement::ApplyToCurrentThread(ThreadRole role) {
+    RoleState& state = m_roles[static_cast<int>(role)];
+    int rc = 0;
+    bool skipped = false;
+
+#ifdef __linux__
+    switch (role) {
+    case ThreadRole::Ui:
+        if (m_uiCpus.empty()) skipped = true;
+        else rc = pinTo(m_uiCpus);
+        break;
+    case ThreadRole::Inference:
+        if (m_inferenceCpus.empty()) skipped = true;
+        else rc = pinTo(m_inferenceCpus);
+        break;
+    case ThreadRole::Audio:
+        if (!m_policy.realtimeAudio) {
+            skipped = true;
+        } else {
+            sched_param param{};
+            param.sched_priority = AUDIO_RT_PRIORITY;
+            rc = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        }
+        break;
+    }
+    state.cpu = sched_getcpu();
+#else
+    skipped = true;
+#endif
+
+    state.error  = rc;
+    state.status = skipped ? Skipped : rc == 0 ? Applied : Failed;
+}
+
+std::string ThreadPlacement::Describe() const {
+#ifndef __linux__
+    return "Thread placement is only supported on Linux.\n";
+#else
+    std::string out;
+    out += "Physical cores: " + std::to_string(m_physicalCores) + "\n";
+    if (m_inferenceCpus.empty()) {
+        out += m_policy.enabled ? "Pinning: off (too few physical cores)\n"
+                                : "Pinning: disabled\n";
+    } else {
+        out += "Inference CPUs: " + cpuList(m_inferenceCpus)
+             + " (one per physical core)\n";
+        out += "UI/terminal CPUs: " + cpuList(m_uiCpus) + "\n";
+    }
+    out += "\n";
+
+    for (ThreadRole role : {ThreadRole::Ui, ThreadRole::Audio, ThreadRole::Inference}) {
+        const RoleState& s = m_roles[static_cast<int>(role)];
+        out += std::string(roleName(role)) + " thread: ";
+        switch (s.status.load()) {
+        case NotApplied:
+            out += "not started yet";
+            break;
+        case Skipped:
+            out += role == ThreadRole::Audio ? "default priority (real-time disabled)"
+                                             : "unpinned";
+            break;
+        case Applied:
+            out += role == ThreadRole::Audio
+                 ? "SCHED_FIFO priority " + std::to_string(AUDIO_RT_PRIORITY)
+                 : "pinned";
+            break;
+        case Failed:
+            out += std::string(role == ThreadRole::Audio ? "default priority" : "unpinned")
+                 + " (" + std::strerror(s.error.load()) + ")";
+            break;
+        }
+        if (s.cpu.load() >= 0)
+            out += ", last seen on CPU " + std::to_string(s.cpu.load());
+        out += "\n";
+    }
+    return out;
+#endif
+}
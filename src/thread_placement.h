@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+/// Which part of the app a thread belongs to.
+enum class ThreadRole { Ui, Audio, Inference };
+
+/// Decides where the app's threads run and applies that to the calling
+/// thread.
+///
+///  - Inference (the streaming and model-load threads) is pinned to one
+///    logical CPU on each of a set of physical cores.  whisper's worker
+///    threads are created by the inference thread, so they inherit the
+///    same CPUs.
+///  - The UI thread goes to the remaining physical cores.  The terminal
+///    child process and anything it runs (e.g. a build) inherits that
+///    mask for good, so it can't crowd out inference — but it is also
+///    held to those few cores when nobody is dictating.  That's why
+///    pinning is opt-in.
+///  - The audio callback thread asks for SCHED_FIFO where permitted.
+///
+/// Linux only; elsewhere every call is a no-op and Describe() says so.
+/// Configure() before any thread applies it; after that the object is
+/// read-only apart from the per-role status, which is atomic.
+class ThreadPlacement {
+public:
+    struct Policy {
+        bool enabled        = false;  // pin UI and inference threads
+        bool realtimeAudio  = true;   // SCHED_FIFO for the audio callback
+        int  inferenceCores = 0;      // physical cores for inference; 0 = auto
+        std::vector<int> cpus;        // CPUs the process may use; empty = current affinity
+    };
+
+    /// Detect the CPU topology and plan the CPU sets.  With
+    /// Policy::cpus, first moves the calling thread onto those CPUs, so
+    /// a child spawned from a pinned thread gets its parent's whole
+    /// process mask back.  Not thread-safe.
+    void Configure(const Policy& policy);
+
+    const Policy& GetPolicy() const { return m_policy; }
+
+    /// Apply the policy for @p role to the calling thread.  Makes no
+    /// allocations, so it's safe on the audio thread.
+    void ApplyToCurrentThread(ThreadRole role);
+
+    /// Logical CPUs inference is pinned to; 0 if it isn't pinned.
+    int InferenceCpuCount() const { return static_cast<int>(m_inferenceCpus.size()); }
+
+    /// Every CPU the process was allowed when configured, before any
+    /// pinning; what a child process should plan over.
+    const std::vector<int>& ProcessCpus() const { return m_processCpus; }
+
+    /// Human-readable plan and per-role outcome, for the diagnostics view.
+    std::string Describe() const;
+
+private:
+    // Outcome of the last ApplyToCurrentThread() per role.
+    enum Status : int { NotApplied = 0, Applied, Skipped, Failed };
+    struct RoleState {
+        std::atomic<int> status{NotApplied};
+        std::atomic<int> error{0};      // errno when Failed
+        std::atomic<int> cpu{-1};       // CPU the thread was on when applied
+    };
+
+    Policy           m_policy;
+    int              m_physicalCores = 0;
+    std::vector<int> m_processCpus;
+    std::vector<int> m_inferenceCpus;   // empty → not pinned
+    std::vector<int> m_uiCpus;
+    RoleState        m_roles[3];
+};
@@ -1,36 +1,106 @@
 #define MINIAUDIO_IMPLEMENTATION
 #include "transcriber.h"
+#include "model_loader.h"
+#include "thread_placement.h"
+#include "transcript_text.h"
 #include <whisper.h>
 #include <chrono>
 #include <algorithm>
+#include <cstdio>
+#include <sstream>
 
-static constexpr int INITIAL_INTERVAL_MS   = 300;                      // first partial fires quickly
-static constexpr int STREAM_INTERVAL_MS    = 400;                      // subsequent partials
+static constexpr int MIN_WAIT_MS           = 10;                       // floor on a scheduler sleep
+static constexpr int WAKE_SLACK_SAMPLES    = WHISPER_SAMPLE_RATE / 50; // 20 ms — callback granularity
 static constexpr int MIN_SAMPLES           = WHISPER_SAMPLE_RATE / 4;  // need ≥0.25 s of audio
-static constexpr int COMMIT_SAMPLES        = WHISPER_SAMPLE_RATE * 25; // commit chunk every 25 s
+static constexpr int WINDOW_SAMPLES        = WHISPER_SAMPLE_RATE * 10; // max audio decoded per pass
+static constexpr int OVERLAP_SAMPLES       = WHISPER_SAMPLE_RATE / 5;  // context kept across a window lock
+static constexpr int PAUSE_COMMIT_SAMPLES  = WHISPER_SAMPLE_RATE * 4 / 5; // silence that ends a phrase
+static constexpr int PREROLL_SAMPLES       = WHISPER_SAMPLE_RATE * 3 / 10; // kept before speech onset
+static constexpr int TAIL_GUARD_SAMPLES    = WHISPER_SAMPLE_RATE;      // words this close to the end stay open
+static constexpr int PROMPT_TAIL_CHARS     = 600;                      // confirmed text used as context
+static constexpr int MAX_PROMPT_TOKENS     = 128;                      // of committed text
+static constexpr int GLOSSARY_TOKENS       = 64;                       // project terms first; total < n_text_ctx / 2
+static constexpr int FINAL_BUDGET_MS       = 1000;                     // least time the accurate tail pass gets
+static constexpr int FINAL_BUDGET_MAX_MS   = 4000;                     // most Stop waits on it; slower → skipped
+static constexpr double FINAL_BUDGET_SLACK = 1.5;                      // budget over the expected pass time
+static constexpr double FINAL_SKIP_DECAY   = 0.8;                      // per skip, so a busy spell doesn't last
+static constexpr int MIN_DECODE_SAMPLES    = WHISPER_SAMPLE_RATE * 11 / 10; // whisper skips clips under 1 s
 static constexpr int SHUTDOWN_TIMEOUT_MS   = 200;                      // max wait for thread on shutdown
+static constexpr int CAPTURE_RING_SAMPLES  = WHISPER_SAMPLE_RATE * 30; // slack while inference runs
+static constexpr int COMMAND_POLL_MS       = 20;                       // end-of-command check interval
+static constexpr int COMMAND_LISTEN_MS     = 5000;                     // give up if nothing is said
+static constexpr int COMMAND_END_SAMPLES   = WHISPER_SAMPLE_RATE * 7 / 20; // pause that ends a command
+static constexpr int COMMAND_MAX_SAMPLES   = WHISPER_SAMPLE_RATE * 3;  // longest command we wait for
+static constexpr int CANCEL_GRACE_MS       = 150;                      // worker must go idle within this, or is killed
+static constexpr int ENCODER_FRAME_SAMPLES = WHISPER_SAMPLE_RATE / 50; // one encoder position = 20 ms
+static constexpr int AUDIO_CTX_MARGIN      = 50;                       // encoder positions past the audio (1 s)
+static constexpr int AUDIO_CTX_ALIGN       = 64;                       // round the context up to this
+static constexpr int PIECE_MIN_SAMPLES     = WHISPER_SAMPLE_RATE * 8;  // shortest piece worth a decode
+static constexpr int PIECE_MAX_SAMPLES     = WHISPER_SAMPLE_RATE * 25; // fits one encoder window; longer finals are cut
+static constexpr int MAX_PIECE_STATES      = 4;                        // concurrent piece decodes
+static constexpr int MIN_PIECE_THREADS     = 2;                        // whisper threads per piece decode
 
-static int inferenceThreadCount() {
+/// Fallback when no calibrated count is available yet.
+static int defaultThreadCount() {
     unsigned n = std::thread::hardware_concurrency();
     return static_cast<int>(std::max(4u, std::min(n, 16u)));
 }
 
+static std::string trimmed(const std::string& str) {
+    auto s = str.find_first_not_of(" \t\n\r");
+    auto e = str.find_last_not_of(" \t\n\r");
+    if (s == std::string::npos || e == std::string::npos) return "";
+    return str.substr(s, e - s + 1);
+}
+
+/// Encoder context for a partial over @p samples of audio: their length
+/// plus a quarter and AUDIO_CTX_MARGIN, so the last words keep some
+/// trailing context, or 0 (whisper's full 30 s) if that's no smaller.
+static int adaptiveAudioCtx(whisper_context* ctx, size_t samples) {
+    int frames = static_cast<int>((samples + ENCODER_FRAME_SAMPLES - 1) / ENCODER_FRAME_SAMPLES);
+    int want   = frames + frames / 4 + AUDIO_CTX_MARGIN;
+    want = (want + AUDIO_CTX_ALIGN - 1) / AUDIO_CTX_ALIGN * AUDIO_CTX_ALIGN;
+    return want < whisper_n_audio_ctx(ctx) ? want : 0;
+}
+
+/// whisper timestamps are in 10 ms units.
+static int64_t timestampToSample(int64_t t) {
+    return t * WHISPER_SAMPLE_RATE / 100;
+}
+
+static std::string joined(const std::string& a, const std::string& b) {
+    if (a.empty()) return b;
+    if (b.empty()) return a;
+    return a + " " + b;
+}
+
 // ============================================================================
 // Lifecycle
 // ============================================================================
 
-Transcriber::Transcriber() {}
+Transcriber::Transcriber()
+    : m_captureRing(CAPTURE_RING_SAMPLES)
+{}
 
 Transcriber::~Transcriber() {
+    m_shutdown        = true;
     m_recording       = false;
     m_cancelled       = true;
     m_abortInference  = true;
     m_stopCv.notify_all();
 
-    if (m_warmupThread.joinable())
-        m_warmupThread.join();
+    // Kills the worker process, if any — nothing to wait for.
+    {
+        std::lock_guard<std::mutex> lk(m_workerMutex);
+        m_worker.reset();
+    }
+
+    // A model load in flight can't be interrupted safely; it finishes
+    // and the warmup that follows aborts immediately.
+    if (m_loadThread.joinable())
+        m_loadThread.join();
 
-    StopDevice();
+    StopSource();
 
     if (m_streamThread.joinable()) {
         // Give the thread a moment to notice the abort flag and exit.
@@ -46,206 +116,838 @@ Transcriber::~Transcriber() {
             m_streamThread.join();
         } else {
             m_streamThread.detach();
-            m_whisperCtx = nullptr;   // thread still owns it — don't free
+            m_whisperCtx = nullptr;   // thread still owns them — don't free
+            m_finalCtx   = nullptr;
+            m_fastStates.Abandon();
+            m_finalStates.Abandon();
         }
     }
 
+    m_fastStates.Clear();
+    m_finalStates.Clear();
     if (m_whisperCtx)
         whisper_free(m_whisperCtx);
+    if (m_finalCtx)
+        whisper_free(m_finalCtx);
 }
 
-bool Transcriber::Init(const std::string& modelPath) {
-    m_whisperCtx = whisper_init_from_file(modelPath.c_str());
-    if (!m_whisperCtx) return false;
+bool Transcriber::Init(const std::string& modelPath, const std::string& finalModelPath) {
+    FILE* probe = std::fopen(modelPath.c_str(), "rb");
+    if (!probe) return false;
+    std::fclose(probe);
+
+    m_modelPath      = modelPath;
+    m_finalModelPath = finalModelPath;
+    if (!m_workerPath.empty())
+        return InitWorker();
+
+    // whisper_init blocks for as long as it takes to read the weights —
+    // seconds for the larger models — so keep it off the UI thread.
+    m_loadBusy   = true;
+    m_loadThread = std::thread([this, modelPath, finalModelPath] {
+        if (m_placement)
+            m_placement->ApplyToCurrentThread(ThreadRole::Inference);
+        LoadModel(modelPath, finalModelPath);
+        m_loadBusy = false;
+    });
+    return true;
+}
+
+void Transcriber::LoadModel(const std::string& modelPath, const std::string& finalModelPath) {
+    NotifyModelState(ModelState::Loading, 0);
+
+    ModelFileLoader file(modelPath, [this](int pct) {
+        NotifyModelState(ModelState::Loading, pct);
+    });
+    if (file.IsOpen())
+        m_whisperCtx = whisper_init_with_params(file.Loader(),
+                                                whisper_context_default_params());
+
+    if (!m_whisperCtx) {
+        m_loadFailed = true;
+        m_warmupDone = true;
+        m_stopCv.notify_all();
+        NotifyModelState(ModelState::Failed, 0);
+        return;
+    }
+    m_melUsable = whisper_model_n_mels(m_whisperCtx) == m_mel.NumMels();
 
     // Run a throwaway inference on silence so whisper pre-allocates its
     // internal buffers now instead of on the first real recording.
-    // This runs on a background thread so the UI isn't blocked.
+    // Without a saved thread count, the warmup is a calibration run.
     // The streaming loop polls m_warmupDone before its first inference —
     // audio capture starts immediately regardless.
-    m_warmupThread = std::thread([this] {
-        std::vector<float> silence(WHISPER_SAMPLE_RATE / 2, 0.0f); // 0.5 s
-        RunWhisper(silence, /*partial=*/true);
+    std::vector<float> silence(WHISPER_SAMPLE_RATE / 2, 0.0f); // 0.5 s
+    if (m_threadCount <= 0)
+        Calibrate();
+    else
+        RunWhisper(m_whisperCtx, silence, /*partial=*/true);
+    m_warmupDone = true;
+    NotifyModelState(ModelState::Ready, 100);
+
+    // The accurate model is only needed when a recording ends, so it
+    // loads after the fast one is already serving partials.  If it's
+    // missing or fails to load, Stop/Send just keep the partial text.
+    if (finalModelPath.empty() || finalModelPath == modelPath || m_shutdown)
+        return;
+    ModelFileLoader finalFile(finalModelPath, nullptr);
+    if (!finalFile.IsOpen())
+        return;
+    whisper_context* finalCtx = whisper_init_with_params(finalFile.Loader(),
+                                                         whisper_context_default_params());
+    if (!finalCtx)
+        return;
+    // A final pass encodes the full 30 s whatever the audio, so the
+    // warmup's time is a fair first guess at every later one.
+    auto warmupStart = std::chrono::steady_clock::now();
+    RunWhisper(finalCtx, silence, /*partial=*/false);
+    m_finalPassMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - warmupStart).count());
+    m_finalCtx   = finalCtx;
+    m_finalReady = true;
+}
+
+void Transcriber::Calibrate() {
+    // SMT siblings and efficiency cores often make "all hardware
+    // threads" slower than fewer, so time a spread of counts.
+    int hw = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (m_placement && m_placement->InferenceCpuCount() > 0)
+        hw = m_placement->InferenceCpuCount();
+    std::vector<int> candidates;
+    for (int n : {2, 4, 6, 8, 12, 16, hw / 2, hw})
+        if (n >= 1 && n <= hw
+            && std::find(candidates.begin(), candidates.end(), n) == candidates.end())
+            candidates.push_back(n);
+    std::sort(candidates.begin(), candidates.end());
+
+    // A short utterance's worth of audio, encoded over the same reduced
+    // context a partial of it would get.
+    std::vector<float> probe(WHISPER_SAMPLE_RATE * 2, 0.0f);
+
+    // First run pays whisper's one-time allocations — don't time it.
+    m_threadCount = defaultThreadCount();
+    RunWhisper(m_whisperCtx, probe, /*partial=*/true);
+
+    int    best      = defaultThreadCount();
+    double bestTime  = 1e9;
+    bool   disturbed = false;   // a Stop/Cancel aborted a timing run
+    for (size_t i = 0; i < candidates.size() && !m_shutdown; ++i) {
+        NotifyModelState(ModelState::Calibrating,
+                         static_cast<int>(i * 100 / candidates.size()));
+        m_threadCount = candidates[i];
+
+        // Best of two, to shrug off a one-off scheduling hiccup.
+        double t = 1e9;
+        for (int rep = 0; rep < 2; ++rep) {
+            auto start = std::chrono::steady_clock::now();
+            RunWhisper(m_whisperCtx, probe, /*partial=*/true);
+            t = std::min(t, std::chrono::duration<double>(
+                    std::chrono::steady_clock::now() - start).count());
+        }
+        if (m_abortInference || m_cancelled) {
+            disturbed = true;
+            break;
+        }
+        if (t < bestTime) {
+            bestTime = t;
+            best     = candidates[i];
+        }
+    }
+
+    m_threadCount = best;
+    m_calibrated  = !disturbed && !m_shutdown;
+}
+
+bool Transcriber::Recalibrate() {
+    if (m_worker) {
+        if (m_recording || m_loadBusy || m_loadFailed) return false;
+        m_loadBusy   = true;
+        m_calibrated = false;
+        m_worker->Send("recalibrate");
+        return true;
+    }
+    if (m_recording || !m_warmupDone || m_loadFailed || m_loadBusy)
+        return false;
+
+    // The last session's thread may still be finishing its final pass.
+    if (m_streamThread.joinable()) {
+        if (!m_threadDone) return false;
+        m_streamThread.join();
+    }
+    m_cancelled      = false;
+    m_abortInference = false;
+
+    if (m_loadThread.joinable())
+        m_loadThread.join();
+
+    // Reuse the warmup gate: a recording started meanwhile buffers its
+    // audio until calibration is done, just like during loading.
+    m_warmupDone = false;
+    m_calibrated = false;
+    m_loadBusy   = true;
+    m_loadThread = std::thread([this] {
+        if (m_placement)
+            m_placement->ApplyToCurrentThread(ThreadRole::Inference);
+        Calibrate();
         m_warmupDone = true;
+        NotifyModelState(ModelState::Ready, 100);
+        m_loadBusy = false;
     });
-
     return true;
 }
 
+int Transcriber::InferenceThreads() const {
+    int n = m_threadCount > 0 ? m_threadCount.load() : defaultThreadCount();
+    // More threads than pinned CPUs would just time-slice each other.
+    if (m_placement && m_placement->InferenceCpuCount() > 0)
+        n = std::min(n, m_placement->InferenceCpuCount());
+    return n;
+}
+
+void Transcriber::NotifyModelState(ModelState state, int percent) {
+    std::lock_guard<std::mutex> lk(m_cbMutex);
+    if (m_modelCallback)
+        m_modelCallback(state, percent);
+}
+
 // ============================================================================
 // Recording control
 // ============================================================================
 
-void Transcriber::StartRecording() {
-    if (m_recording || !m_whisperCtx) return;
+bool Transcriber::BeginSession() {
+    // The model may still be loading — that's fine, the streaming loop
+    // buffers audio until it's ready.
+    if (m_recording || m_loadFailed) return false;
 
-    // Ensure any previous streaming thread is fully stopped.
-    m_cancelled      = true;
-    m_abortInference = true;
-    m_stopCv.notify_all();
-    if (m_streamThread.joinable())
+    // Ensure any previous streaming thread is fully stopped.  (Leave the
+    // flags alone otherwise — a calibration run may be using them.)
+    if (m_streamThread.joinable()) {
+        m_cancelled      = true;
+        m_abortInference = true;
+        m_stopCv.notify_all();
         m_streamThread.join();
+    }
 
     // Reset flags for the new session
     m_cancelled      = false;
     m_abortInference = false;
     m_threadDone     = false;
 
+    // The previous source is stopped and its thread joined, so nothing
+    // is writing to the ring right now.
+    m_source.reset();
+    m_captureRing.Reset();
+    m_vad.Reset();
+    m_mel.Reset();
+    m_store.Reset(m_compactAudio ? AudioStore::Format::Int16 : AudioStore::Format::Float32);
+    m_windowStart = 0;
+    m_confirmedText.clear();
+    m_promptTokens.clear();
+    return true;
+}
+
+void Transcriber::StartRecording() {
+    StartRecording(std::make_unique<DeviceCaptureSource>());
+}
+
+bool Transcriber::StartRecording(std::unique_ptr<CaptureSource> source) {
+    return StartSession(std::move(source), /*command=*/false);
+}
+
+bool Transcriber::StartCommand() {
+    return StartCommand(std::make_unique<DeviceCaptureSource>());
+}
+
+bool Transcriber::StartCommand(std::unique_ptr<CaptureSource> source) {
+    return StartSession(std::move(source), /*command=*/true);
+}
+
+void Transcriber::SetGlossary(const std::vector<std::string>& terms) {
+    std::string list;
+    for (const auto& t : terms)
+        list += (list.empty() ? "" : "\t") + t;
+
     {
-        std::lock_guard<std::mutex> lk(m_audioMutex);
-        m_audioBuffer.clear();
+        std::lock_guard<std::mutex> lk(m_glossaryMutex);
+        m_glossary.clear();
+        for (const auto& t : terms)
+            m_glossary += (m_glossary.empty() ? " " : ", ") + t;
+        m_glossaryList = list;
     }
-    m_confirmedText.clear();
+    ++m_glossaryVersion;
 
-    ma_device_config cfg = ma_device_config_init(ma_device_type_capture);
-    cfg.capture.format   = ma_format_f32;
-    cfg.capture.channels = 1;
-    cfg.sampleRate       = WHISPER_SAMPLE_RATE;
-    cfg.dataCallback     = AudioDataCallback;
-    cfg.pUserData        = this;
+    // Called from the project scan's thread, so m_worker may be
+    // appearing on the UI thread right now (InitWorker).
+    std::lock_guard<std::mutex> lk(m_workerMutex);
+    if (m_worker)
+        m_worker->Send("glossary " + InferenceWorker::Escape(list), /*sticky=*/true);
+}
+
+void Transcriber::SetCommandVocabulary(const std::vector<std::string>& phrases) {
+    m_commandPhrases  = phrases;
+    m_commandsChanged = true;
 
-    if (m_deviceInit) {
-        ma_device_uninit(&m_device);
-        m_deviceInit = false;
+    if (m_worker) {
+        std::string list;
+        for (const auto& p : phrases)
+            list += (list.empty() ? "" : "\t") + p;
+        m_worker->Send("vocab " + InferenceWorker::Escape(list), /*sticky=*/true);
     }
-    if (ma_device_init(nullptr, &cfg, &m_device) != MA_SUCCESS)
-        return;
-    m_deviceInit = true;
+}
 
-    if (ma_device_start(&m_device) != MA_SUCCESS) {
-        ma_device_uninit(&m_device);
-        m_deviceInit = false;
-        return;
+bool Transcriber::StartSession(std::unique_ptr<CaptureSource> source, bool command) {
+    if (!source || !BeginSession()) return false;
+
+    m_commandMode = command;
+    m_source = std::move(source);
+    if (!m_source->Open()) {
+        m_source.reset();
+        return false;
     }
 
+    // The source delivers at its own rate and channel count; m_frontEnd
+    // converts to conditioned 16 kHz mono.
+    m_frontEnd.Configure(m_source->SampleRate(), m_source->Channels());
+    m_frontEnd.SetAutoGain(m_autoGain);
+    m_audioPlaced = false;
+
+    // Set before Start(): the sink drops frames while not recording.
     m_recording = true;
+    if (m_worker)
+        return StartWorkerSession();
+    if (!m_source->Start([this](const float* frames, size_t count) {
+            OnCapturedFrames(frames, count);
+        }))
+    {
+        m_recording = false;
+        m_source.reset();
+        return false;
+    }
+
     m_streamThread = std::thread(&Transcriber::StreamingLoop, this);
+    return true;
 }
 
-void Transcriber::StopRecording() {
-    if (!m_recording) return;
+bool Transcriber::CaptureFinished() const {
+    return m_source && m_source->Finished();
+}
 
-    // Stop the microphone and tell the streaming loop to exit without
-    // doing a final pass.  The UI will keep whatever text the last
-    // partial produced — no need to wait for another inference.
+bool Transcriber::StopRecording() {
+    if (!m_recording) return false;
+
+    // Stop capture first: the sink drops frames once m_recording is
+    // cleared, and a source forwards what it still holds while stopping.
+    StopSource();
+
+    // Then abort the partial in flight.  The streaming loop runs the
+    // final pass (bounded by FINAL_BUDGET_MS) and delivers it with
+    // is_final = true.
     m_recording      = false;
-    m_cancelled      = true;
     m_abortInference = true;
     m_stopCv.notify_all();
 
-    StopDevice();
+    if (m_worker)
+        m_worker->Send("stop");   // after the last frame is in the ring
     // Thread exits on its own.  Joined in StartRecording() or destructor.
+    return true;
 }
 
 void Transcriber::CancelRecording() {
-    // Identical flags to StopRecording — just a semantic alias for
-    // "discard the result".
-    if (!m_recording && !m_streamThread.joinable()) return;
+    // Like StopRecording, but also skips the final pass — the result
+    // is being discarded (or the UI already has the text it needs).
+    if (!m_recording && !m_streamThread.joinable() && !m_workerSession) return;
 
     m_recording      = false;
     m_cancelled      = true;
     m_abortInference = true;
     m_stopCv.notify_all();
 
-    StopDevice();
+    StopSource();
+
+    // A worker stuck in an encoder pass would keep a core busy for
+    // seconds; past a short grace period it's killed and restarted.
+    if (m_worker) {
+        m_workerSession = false;
+        m_worker->Send("cancel");
+        m_worker->KillUnlessIdle(CANCEL_GRACE_MS);
+    }
     // Thread exits on its own.  Joined in StartRecording() or destructor.
 }
 
-void Transcriber::StopDevice() {
-    if (m_deviceInit) {
-        ma_device_stop(&m_device);
-        ma_device_uninit(&m_device);
-        m_deviceInit = false;
+void Transcriber::StopSource() {
+    // Stopped but kept until the next session, so CaptureFinished()
+    // still answers.
+    if (m_source)
+        m_source->Stop();
+}
+
+// ============================================================================
+// Worker process
+// ============================================================================
+
+bool Transcriber::InitWorker() {
+    m_loadBusy = true;
+    {
+        // Hand it whatever glossary and vocabulary were set before it
+        // existed; sticky, so a restarted worker gets them too.
+        std::lock_guard<std::mutex> lk(m_workerMutex);
+        m_worker = std::make_unique<InferenceWorker>(m_workerPath,
+            [this] { return WorkerArgs(); },
+            [this](const std::string& line) { OnWorkerLine(line); },
+            [this](bool killed) { return OnWorkerExit(killed); });
+        std::string glossary;
+        {
+            std::lock_guard<std::mutex> glk(m_glossaryMutex);
+            glossary = m_glossaryList;
+        }
+        if (!glossary.empty())
+            m_worker->Send("glossary " + InferenceWorker::Escape(glossary), /*sticky=*/true);
+    }
+    if (!m_commandPhrases.empty())
+        SetCommandVocabulary(m_commandPhrases);
+
+    if (!m_worker->Start()) {
+        std::lock_guard<std::mutex> lk(m_workerMutex);
+        m_worker.reset();
+        m_loadBusy = false;
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> Transcriber::WorkerArgs() const {
+    std::vector<std::string> args = {m_modelPath};
+    if (!m_finalModelPath.empty())
+        args.insert(args.end(), {"--final-model", m_finalModelPath});
+    // Once calibrated, a restarted worker can skip calibration.
+    if (m_threadCount > 0)
+        args.insert(args.end(), {"--threads", std::to_string(m_threadCount.load())});
+    if (m_compactAudio)
+        args.push_back("--int16");
+    if (!m_autoGain)
+        args.push_back("--no-agc");
+    if (!m_adaptiveContext)
+        args.push_back("--full-context");
+
+    // The worker inherits the CPUs of whichever thread spawns it (the
+    // pinned UI thread, or the reader on a restart); hand it the whole
+    // process mask and the policy so it can plan its own threads.
+    const ThreadPlacement::Policy policy = m_placement ? m_placement->GetPolicy()
+                                                       : ThreadPlacement::Policy{false, false, 0, {}};
+    if (m_placement && !m_placement->ProcessCpus().empty()) {
+        std::string cpus;
+        for (int c : m_placement->ProcessCpus())
+            cpus += (cpus.empty() ? "" : ",") + std::to_string(c);
+        args.insert(args.end(), {"--cpus", cpus});
+    }
+    if (policy.enabled)
+        args.push_back("--placement");
+    if (!policy.realtimeAudio)
+        args.push_back("--no-realtime-audio");
+    if (policy.inferenceCores > 0)
+        args.insert(args.end(), {"--inference-cores", std::to_string(policy.inferenceCores)});
+    return args;
+}
+
+bool Transcriber::StartWorkerSession() {
+    // No local streaming thread: the worker conditions and decodes, and
+    // this side just copies the source's frames into the shared ring.
+    // The ring position tells the worker where this session starts.
+    m_threadDone = true;
+    {
+        std::lock_guard<std::mutex> lk(m_cbMutex);
+        m_workerText.clear();
+    }
+    SharedAudioRing& ring     = m_worker->Ring();
+    const uint32_t   channels = m_source->Channels();
+    const bool       realTime = m_source->RealTime();
+    m_workerSession = true;
+    m_worker->Send(std::string(m_commandMode ? "command " : "start ")
+                   + std::to_string(m_source->SampleRate()) + " "
+                   + std::to_string(channels) + " "
+                   + std::to_string(ring.WritePosition()));
+
+    if (!m_source->Start([this, &ring, channels, realTime](const float* frames, size_t count) {
+            if (!m_recording) return;
+            if (realTime && m_placement && !m_audioPlaced.exchange(true))
+                m_placement->ApplyToCurrentThread(ThreadRole::Audio);
+            ring.Write(frames, count * channels);
+        }))
+    {
+        m_recording     = false;
+        m_workerSession = false;
+        m_worker->Send("cancel");
+        m_source.reset();
+        return false;
     }
+    return true;
+}
+
+void Transcriber::OnWorkerLine(const std::string& line) {
+    std::istringstream in(line);
+    std::string verb;
+    in >> verb;
+    // The text after "<verb> " (or after "<verb> <n> " for commands).
+    auto textAfter = [&line](size_t fields) {
+        size_t pos = 0;
+        for (size_t i = 0; i < fields && pos != std::string::npos; ++i) {
+            pos = line.find(' ', pos);
+            if (pos != std::string::npos) ++pos;
+        }
+        return pos == std::string::npos ? std::string()
+                                        : InferenceWorker::Unescape(line.substr(pos));
+    };
+
+    if (verb == "model") {
+        int state = 0, percent = 0;
+        in >> state >> percent;
+        auto modelState = static_cast<ModelState>(state);
+        if (modelState == ModelState::Ready) {
+            m_workerReady = true;
+            m_loadBusy    = false;
+        } else if (modelState == ModelState::Failed) {
+            m_loadFailed = true;
+            m_loadBusy   = false;
+        }
+        NotifyModelState(modelState, percent);
+    } else if (verb == "threads") {
+        int n = 0, calibrated = 0;
+        in >> n >> calibrated;
+        m_threadCount = n;
+        m_calibrated  = calibrated != 0;
+    } else if (verb == "partial" || verb == "final") {
+        std::string text = textAfter(1);
+        {
+            std::lock_guard<std::mutex> lk(m_cbMutex);
+            m_workerText = text;
+        }
+        // Anything from a cancelled session is stale.
+        bool isFinal = verb == "final";
+        if (isFinal ? !m_workerSession.exchange(false) : !m_workerSession.load())
+            return;
+        Deliver(text, isFinal);
+    } else if (verb == "nofinal") {
+        FinishWorkerSession();
+    } else if (verb == "command") {
+        int index = -1;
+        in >> index;
+        if (m_workerSession.exchange(false))
+            DeliverCommand(index, textAfter(2));
+    }
+}
+
+void Transcriber::FinishWorkerSession() {
+    if (!m_workerSession.exchange(false) || m_cancelled)
+        return;
+    if (m_commandMode) {
+        DeliverCommand(-1, "");
+        return;
+    }
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lk(m_cbMutex);
+        text = m_workerText;
+    }
+    Deliver(text, /*isFinal=*/true);
+}
+
+bool Transcriber::OnWorkerExit(bool killed) {
+    // A session in flight settles for what it had, so the UI isn't left
+    // waiting on a worker that's gone.
+    FinishWorkerSession();
+
+    // Dying on its own before the model ever loaded points at the model;
+    // a restart would only do the same.
+    if (!m_workerReady.exchange(false) && !killed) {
+        m_loadFailed = true;
+        m_loadBusy   = false;
+        NotifyModelState(ModelState::Failed, 0);
+        return false;
+    }
+    if (m_shutdown)
+        return false;
+    m_loadBusy = true;
+    NotifyModelState(ModelState::Loading, 0);
+    return true;
 }
 
 // ============================================================================
-// miniaudio capture callback (audio thread)
+// Capture sink (audio thread, or a replay source's thread)
 // ============================================================================
 
-void Transcriber::AudioDataCallback(ma_device* pDevice, void* /*pOutput*/,
-                                    const void* pInput, ma_uint32 frameCount)
-{
-    auto* self = static_cast<Transcriber*>(pDevice->pUserData);
-    if (!pInput || !self->m_recording) return;
+void Transcriber::OnCapturedFrames(const float* frames, size_t count) {
+    if (!m_recording) return;
+
+    // The source owns this thread, so raise its priority from inside on
+    // the first callback of each session — a device's callback only;
+    // SCHED_FIFO on a replay thread that sleeps or blocks on a pipe
+    // buys nothing and can starve the rest of the process.
+    if (m_placement && !m_audioPlaced.exchange(true) && m_source->RealTime())
+        m_placement->ApplyToCurrentThread(ThreadRole::Audio);
 
-    const auto* samples = static_cast<const float*>(pInput);
-    std::lock_guard<std::mutex> lk(self->m_audioMutex);
-    self->m_audioBuffer.insert(self->m_audioBuffer.end(),
-                               samples, samples + frameCount);
+    // Real-time thread: no locks, no allocation.  The front-end converts
+    // the native-format frames to conditioned 16 kHz mono in fixed
+    // blocks.  If the streaming thread falls more than
+    // CAPTURE_RING_SAMPLES behind, the excess is dropped rather than
+    // stalling capture.
+    m_frontEnd.Process(frames, count, [this](const float* samples, size_t n) {
+        m_captureRing.Write(samples, n);
+    });
+    m_lastCaptureTick = std::chrono::steady_clock::now().time_since_epoch().count();
 }
 
 // ============================================================================
 // Streaming loop (background thread)
 // ============================================================================
 
+bool Transcriber::DrainCapture() {
+    size_t avail = m_captureRing.Available();
+    if (avail == 0) return false;
+
+    // The ring is drained completely, so its newest sample arrived with
+    // the latest callback (or very nearly).
+    m_windowCaptured = m_lastCaptureTick.load();
+
+    // Grows to the largest backlog once, then is reused.
+    m_drainBuffer.resize(avail);
+    size_t got = m_captureRing.Read(m_drainBuffer.data(), avail);
+    m_store.Append(m_drainBuffer.data(), got);
+    m_mel.Append(m_drainBuffer.data(), got);
+
+    return m_vad.Process(m_drainBuffer.data(), got);
+}
+
+void Transcriber::DropWindowFront(size_t count) {
+    count = std::min(count, WindowSamples());
+    count -= count % IncrementalMel::HOP;
+    m_windowStart += count;
+    m_mel.DropFront(count);
+
+    // Everything before the window is committed text now; the final
+    // pass only decodes the window.
+    m_store.Release(m_windowStart);
+}
+
+AudioView Transcriber::PaddedWindow() {
+    AudioView window = Window();
+    if (window.size() >= static_cast<size_t>(MIN_DECODE_SAMPLES)) return window;
+    m_paddedAudio.assign(MIN_DECODE_SAMPLES, 0.0f);
+    window.CopyTo(m_paddedAudio.data());
+    return m_paddedAudio;
+}
+
+void Transcriber::CommitText(const std::string& text) {
+    if (text.empty()) return;
+    if (m_confirmedText.empty())
+        m_confirmedText = text;
+    else
+        m_confirmedText += " " + text;
+    UpdatePromptTokens();
+}
+
+void Transcriber::UpdatePromptTokens() {
+    m_promptTokens = PromptTokens(m_whisperCtx, m_fastGlossary);
+}
+
+const std::vector<int32_t>& Transcriber::GlossaryTokens(whisper_context* ctx, GlossaryCache& cache) {
+    static const std::vector<int32_t> none;
+    if (!ctx) return none;
+
+    uint64_t version = m_glossaryVersion.load();
+    if (cache.version == version) return cache.tokens;
+
+    std::string text;
+    {
+        std::lock_guard<std::mutex> lk(m_glossaryMutex);
+        text = m_glossary;
+    }
+    cache.version = version;
+    cache.tokens.clear();
+
+    // Terms come most important first: keep as many whole ones as fit.
+    // BPE may merge a comma with its neighbours, so rather than look for
+    // a comma token, tokenize each longer run of terms until one doesn't
+    // fit.  Only a handful of short strings, and only on a change.
+    std::vector<int32_t> buf(text.size() + 2);
+    size_t end = 0;
+    while (end < text.size()) {
+        size_t next = std::min(text.find(',', end + 1), text.size());
+        int n = whisper_tokenize(ctx, text.substr(0, next).c_str(), buf.data(),
+                                 static_cast<int>(buf.size()));
+        if (n < 0 || n > GLOSSARY_TOKENS) break;
+        cache.tokens.assign(buf.begin(), buf.begin() + n);
+        end = next;
+    }
+
+    // Not even the first term fits: keep as much of it as does.
+    if (cache.tokens.empty() && !text.empty()) {
+        int n = whisper_tokenize(ctx, text.c_str(), buf.data(), static_cast<int>(buf.size()));
+        cache.tokens.assign(buf.begin(), buf.begin() + std::clamp(n, 0, GLOSSARY_TOKENS));
+    }
+    return cache.tokens;
+}
+
+std::vector<int32_t> Transcriber::PromptTokens(whisper_context* ctx, GlossaryCache& glossary) {
+    if (!ctx) return {};
+
+    // Only the tail matters — whisper keeps at most half its text
+    // context as prompt anyway.  Start the tail on a word boundary.
+    std::string tail = m_confirmedText;
+    if (tail.size() > static_cast<size_t>(PROMPT_TAIL_CHARS)) {
+        tail = tail.substr(tail.size() - PROMPT_TAIL_CHARS);
+        auto sp = tail.find(' ');
+        if (sp != std::string::npos) tail = tail.substr(sp + 1);
+    }
+
+    // A token is at least one byte, so this is always large enough.
+    std::vector<int32_t> tokens(tail.size() + 2);
+    int n = tail.empty() ? 0 : whisper_tokenize(ctx, (" " + tail).c_str(),
+                                                tokens.data(), static_cast<int>(tokens.size()));
+    if (n < 0) n = 0;
+    tokens.resize(n);
+    if (tokens.size() > static_cast<size_t>(MAX_PROMPT_TOKENS))
+        tokens.erase(tokens.begin(), tokens.end() - MAX_PROMPT_TOKENS);
+
+    // The project's glossary goes first, as if it had been said before
+    // everything else, so its spellings carry over.
+    const std::vector<int32_t>& terms = GlossaryTokens(ctx, glossary);
+    tokens.insert(tokens.begin(), terms.begin(), terms.end());
+    return tokens;
+}
+
 void Transcriber::StreamingLoop() {
-    // Wait for the startup warmup inference to finish before touching
-    // the whisper context.  Audio is already being captured into
-    // m_audioBuffer while we wait, so nothing the user says is lost.
+    // This thread calls whisper, whose workers inherit its CPU mask.
+    if (m_placement)
+        m_placement->ApplyToCurrentThread(ThreadRole::Inference);
+
+    // The current window is a range of m_store.  Each tick only appends
+    // what arrived since the last one, and passes read it through a
+    // view rather than a copy.  The window never grows much past
+    // WINDOW_SAMPLES, so the cost of a pass stays bounded no matter how
+    // long the dictation runs.
+    bool newSpeech = false;    // VAD saw speech the last pass hasn't decoded
+
+    // Wait for the model load and warmup inference to finish before
+    // touching the whisper context.  Audio is already being captured
+    // while we wait, so nothing the user says is lost — keep draining
+    // the ring so it doesn't overflow during a slow load.
     while (!m_warmupDone.load()) {
-        if (m_cancelled.load()) {
-            m_threadDone = true;
-            m_stopCv.notify_all();
-            return;
-        }
+        newSpeech |= DrainCapture();
+        if (m_cancelled.load()) break;
         std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
+    if (m_commandMode) {
+        CommandLoop();
+        m_threadDone = true;
+        m_stopCv.notify_all();
+        return;
+    }
 
-    bool firstIter = true;
-    std::string lastPartialText;
+    // Start from the project glossary alone — unless there's no model
+    // to tokenize it with (failed, or cancelled while still loading).
+    if (!m_loadFailed && !m_cancelled)
+        UpdatePromptTokens();
 
-    while (m_recording && !m_cancelled) {
-        int interval = firstIter ? INITIAL_INTERVAL_MS : STREAM_INTERVAL_MS;
-        firstIter = false;
+    std::string lastPartialText;
+    size_t pendingSamples = WindowSamples();   // captured since the last evaluation
 
-        {
+    while (m_recording && !m_cancelled && !m_loadFailed) {
+        // Sleep until enough new audio for the next pass should have
+        // arrived.  The step follows the measured real-time factor, so a
+        // pass that ran long is followed immediately by the next one
+        // instead of a fixed sleep on top.
+        size_t step = m_scheduler.StepSamples(WindowSamples());
+        if (pendingSamples < step) {
+            int waitMs = static_cast<int>((step - pendingSamples) * 1000 / WHISPER_SAMPLE_RATE);
             std::unique_lock<std::mutex> lk(m_stopMutex);
-            m_stopCv.wait_for(lk, std::chrono::milliseconds(interval),
+            m_stopCv.wait_for(lk, std::chrono::milliseconds(std::max(waitMs, MIN_WAIT_MS)),
                               [this] { return !m_recording.load() || m_cancelled.load(); });
         }
         if (!m_recording || m_cancelled) break;
 
-        // Snapshot the audio buffer.  When it exceeds the commit
-        // threshold, save the current partial text as confirmed and
-        // clear the buffer so inference stays fast.
-        std::vector<float> audio;
-        {
-            std::lock_guard<std::mutex> lk(m_audioMutex);
+        // Once the last pass covered a full window, commit it up to the
+        // last complete segment and slide the window forward to there.
+        // A short stretch before the cut is kept so the next pass has
+        // acoustic context; the words it repeats are dropped below.
+        // Then pull in whatever was captured since the last tick.
+        if (WindowSamples() >= static_cast<size_t>(WINDOW_SAMPLES) && !newSpeech) {
+            m_abortInference = false;
+            size_t cut = CommitWindow(Window(), lastPartialText);
+            if (m_abortInference || m_cancelled) break;
+
+            size_t keepFrom = cut > static_cast<size_t>(OVERLAP_SAMPLES)
+                            ? cut - OVERLAP_SAMPLES : 0;
+            DropWindowFront(keepFrom);
+        }
+        size_t before = m_store.End();
+        newSpeech |= DrainCapture();
+        pendingSamples += m_store.End() - before;
+        if (pendingSamples + WAKE_SLACK_SAMPLES < step) continue;
+        pendingSamples = 0;
 
-            if (m_audioBuffer.size() > static_cast<size_t>(COMMIT_SAMPLES)
-                && !lastPartialText.empty())
+        // Nothing new was said since the last pass — re-running whisper
+        // would only reproduce the same text.  A long enough pause after
+        // speech is a natural phrase boundary: commit there and start a
+        // fresh window, which keeps windows short.  While idle, only keep
+        // a little pre-roll so the next onset isn't clipped.
+        if (!newSpeech) {
+            if (!lastPartialText.empty()
+                && m_vad.TrailingSilence() >= static_cast<size_t>(PAUSE_COMMIT_SAMPLES))
             {
-                if (m_confirmedText.empty())
-                    m_confirmedText = lastPartialText;
-                else
-                    m_confirmedText += " " + lastPartialText;
-                m_audioBuffer.clear();
+                CommitText(lastPartialText);
                 lastPartialText.clear();
             }
-
-            audio = m_audioBuffer;
+            if (lastPartialText.empty() && WindowSamples() > static_cast<size_t>(PREROLL_SAMPLES))
+                DropWindowFront(WindowSamples() - PREROLL_SAMPLES);
+            continue;
         }
-        if (static_cast<int>(audio.size()) < MIN_SAMPLES) continue;
+
+        if (WindowSamples() < static_cast<size_t>(MIN_SAMPLES)) continue;
+        newSpeech = false;
+
+        // The project was rescanned mid-dictation.
+        if (m_fastGlossary.version != m_glossaryVersion.load())
+            UpdatePromptTokens();
 
         m_abortInference = false;  // allow this inference to run
-        std::string text = RunWhisper(audio, /*partial=*/true);
+        AudioView window = Window();
+        auto passStart = std::chrono::steady_clock::now();
+        uint64_t trace = BeginTrace(/*isFinal=*/false);
+        m_activeTrace  = trace;
+        std::string text = RunWhisper(m_whisperCtx, window, /*partial=*/true,
+                                      nullptr, /*fromMel=*/true);
+        m_activeTrace  = 0;
         if (m_abortInference || m_cancelled) break;  // aborted mid-inference
+        auto passEnd = std::chrono::steady_clock::now();
+        m_latency.Mark(trace, LatencyMonitor::InferenceEnd, passEnd);
+        double passSec = std::chrono::duration<double>(passEnd - passStart).count();
+        m_scheduler.RecordPass(passSec, window.size());
+        {
+            std::lock_guard<std::mutex> lk(m_cbMutex);
+            if (m_passObserver)
+                m_passObserver(passSec, window.size());
+        }
+        text = DropRepeatedPrefix(m_confirmedText, text);
 
         lastPartialText = text;
 
-        // Build full display: confirmed chunks + current partial
-        std::string displayText;
-        if (m_confirmedText.empty())
-            displayText = text;
-        else if (text.empty())
-            displayText = m_confirmedText;
-        else
-            displayText = m_confirmedText + " " + text;
+        // Full display: confirmed chunks + current partial
+        Deliver(joined(m_confirmedText, text), /*isFinal=*/false, trace);
+    }
 
-        std::lock_guard<std::mutex> lk(m_cbMutex);
-        if (m_callback)
-            m_callback(displayText, /*is_final=*/false);
+    // Stopped (not cancelled): re-transcribe the tail the partials may
+    // have missed, and keep everything committed before it as is.
+    if (!m_cancelled) {
+        newSpeech |= DrainCapture();
+        std::string tailText = lastPartialText;
+        uint64_t trace = BeginTrace(/*isFinal=*/true);
+        m_activeTrace  = trace;
+        if (!m_loadFailed)
+            FinalPass(tailText, /*stale=*/newSpeech);
+        m_activeTrace  = 0;
+        m_latency.Mark(trace, LatencyMonitor::InferenceEnd);
+        if (!m_cancelled)
+            Deliver(joined(m_confirmedText, tailText), /*isFinal=*/true, trace);
     }
 
     // Signal that the thread is done so the destructor doesn't block.
@@ -253,13 +955,287 @@ void Transcriber::StreamingLoop() {
     m_stopCv.notify_all();
 }
 
+void Transcriber::CommandLoop() {
+    // Listen until the speaker pauses after a command, or gives up
+    // before saying anything.  Until speech starts, only a little
+    // pre-roll is kept, so the window ends up holding just the command.
+    auto giveUp = std::chrono::steady_clock::now()
+                + std::chrono::milliseconds(COMMAND_LISTEN_MS);
+    while (m_recording && !m_cancelled && !m_loadFailed) {
+        DrainCapture();
+        if (m_vad.HeardSpeech()) {
+            if (m_vad.TrailingSilence() >= static_cast<size_t>(COMMAND_END_SAMPLES)
+                || WindowSamples() >= static_cast<size_t>(COMMAND_MAX_SAMPLES))
+                break;
+        } else {
+            if (std::chrono::steady_clock::now() >= giveUp) break;
+            if (WindowSamples() > static_cast<size_t>(PREROLL_SAMPLES))
+                DropWindowFront(WindowSamples() - PREROLL_SAMPLES);
+        }
+        std::unique_lock<std::mutex> lk(m_stopMutex);
+        m_stopCv.wait_for(lk, std::chrono::milliseconds(COMMAND_POLL_MS),
+                          [this] { return !m_recording.load() || m_cancelled.load(); });
+    }
+    // The capture sink drops frames from here on; the UI releases the
+    // device once the result is in.
+    m_recording = false;
+    if (m_cancelled || m_loadFailed) return;
+    DrainCapture();
+
+    if (m_commandsChanged.exchange(false))
+        m_commandGrammar.Build(m_whisperCtx, m_commandPhrases);
+    if (!m_vad.HeardSpeech() || m_commandGrammar.Empty()) {
+        DeliverCommand(-1, "");
+        return;
+    }
+
+    // The grammar ends the decode within a few tokens of the longest
+    // phrase.
+    m_abortInference = false;
+    m_activeGrammar  = &m_commandGrammar;
+    std::string heard = RunWhisper(m_whisperCtx, PaddedWindow(), /*partial=*/true);
+    m_activeGrammar  = nullptr;
+    if (m_cancelled) return;
+
+    // The grammar always yields some phrase; keep it only if the model
+    // found it plausible on its own.
+    int index = m_commandGrammar.Match(heard);
+    if (!m_commandGrammar.Plausible())
+        index = -1;
+    DeliverCommand(index, heard);
+}
+
+size_t Transcriber::CommitWindow(const AudioView& audio,
+                                 std::string& pendingText)
+{
+    const size_t fallbackCut = audio.size() - OVERLAP_SAMPLES;
+
+    std::vector<TimedText> segments;
+    RunWhisper(m_whisperCtx, audio, /*partial=*/false, &segments);
+    if (m_abortInference || m_cancelled) return 0;
+
+    if (segments.empty()) {
+        // Nothing decoded this time — keep what the last partial saw.
+        CommitText(pendingText);
+        pendingText.clear();
+        return fallbackCut;
+    }
+
+    auto concat = [](const std::vector<TimedText>& parts, size_t from, size_t to) {
+        std::string out;
+        for (size_t i = from; i < to; ++i) out += parts[i].text;
+        return out;
+    };
+
+    // Every segment but the last ended on a timestamp token, so it's
+    // complete.  The last one may be cut off mid-word by the window
+    // edge — leave it in the buffer.
+    const size_t last = segments.size() - 1;
+    std::string committed = concat(segments, 0, last);
+    std::string pending   = segments[last].text;
+    int64_t     cut       = segments[last].start;
+
+    // If the open segment is long (or is the only one), split it at the
+    // last word boundary that's safely away from the window edge, so the
+    // next window doesn't start out nearly full.
+    if (static_cast<int64_t>(audio.size()) - cut > WINDOW_SAMPLES / 2) {
+        const auto& words = segments[last].words;
+        const int64_t guard = static_cast<int64_t>(audio.size()) - TAIL_GUARD_SAMPLES;
+        size_t split = 0;
+        for (size_t i = words.size(); i-- > 1; ) {
+            bool wordStart = !words[i].text.empty() && words[i].text[0] == ' ';
+            if (wordStart && words[i].start > cut && words[i].start <= guard) {
+                split = i;
+                break;
+            }
+        }
+
+        if (split == 0) {
+            // No usable boundary — commit the whole window.
+            CommitText(DropRepeatedPrefix(m_confirmedText, trimmed(committed + pending)));
+            pendingText.clear();
+            return fallbackCut;
+        }
+        committed += concat(words, 0, split);
+        pending    = concat(words, split, words.size());
+        cut        = words[split].start;
+    }
+
+    CommitText(DropRepeatedPrefix(m_confirmedText, trimmed(committed)));
+    pendingText = DropRepeatedPrefix(m_confirmedText, trimmed(pending));
+    return static_cast<size_t>(std::max<int64_t>(0,
+        std::min<int64_t>(cut, static_cast<int64_t>(audio.size()))));
+}
+
+void Transcriber::FinalPass(std::string& pending, bool stale) {
+    // Everything before the window is committed, so only the window —
+    // the audio since the last commit, normally about WINDOW_SAMPLES —
+    // needs a second look.  Without the accurate model that's only worth
+    // it if the partials missed speech, e.g. the last words before Stop.
+    //
+    // The window only runs long when the streaming thread fell behind
+    // (a slow model load, a busy machine).  No partial covered it then,
+    // so it's split at pauses and the pieces are decoded concurrently.
+    bool accurate = m_finalReady.load();
+    bool longTail = WindowSamples() > static_cast<size_t>(PIECE_MAX_SAMPLES);
+    stale |= longTail;
+    if ((!accurate && !stale) || WindowSamples() == 0)
+        return;
+    AudioView tail = PaddedWindow();
+    std::vector<size_t> cuts;
+    if (longTail) {
+        m_pcmScratch.resize(tail.size());
+        tail.CopyTo(m_pcmScratch.data());
+        cuts = FindPauseCuts(m_pcmScratch.data(), m_pcmScratch.size(),
+                             PIECE_MIN_SAMPLES, PIECE_MAX_SAMPLES);
+    }
+    std::string result;
+
+    // The accurate model, seeded with the committed text so the tail
+    // continues it in the same style.  The budget follows its measured
+    // pass time, so a slow CPU doesn't abort every pass; one expected to
+    // overrun even the longest budget isn't started, rather than make
+    // Stop wait for text that gets thrown away.  Whatever it produced
+    // before an abort is incomplete.  Pieces get one budget per round of
+    // concurrent decodes.
+    const int expectMs = m_finalPassMs.load();
+    if (accurate && expectMs > FINAL_BUDGET_MAX_MS) {
+        ++m_finalSkipped;
+        m_finalPassMs = static_cast<int>(expectMs * FINAL_SKIP_DECAY);
+        accurate = false;
+    }
+    if (accurate) {
+        m_finalPromptTokens = PromptTokens(m_finalCtx, m_finalGlossary);
+        const int budgetMs = std::clamp(static_cast<int>(expectMs * FINAL_BUDGET_SLACK),
+                                        FINAL_BUDGET_MS, FINAL_BUDGET_MAX_MS);
+        const int rounds = cuts.empty() ? 1 : static_cast<int>((cuts.size() + MAX_PIECE_STATES) / MAX_PIECE_STATES);
+        const auto start = std::chrono::steady_clock::now();
+        const auto deadline = start + std::chrono::milliseconds(budgetMs * rounds);
+        m_finalDeadline  = deadline.time_since_epoch().count();
+        m_abortInference = false;
+        result = cuts.empty() ? RunWhisper(m_finalCtx, tail, /*partial=*/false)
+                              : DecodePieces(m_finalCtx, m_finalStates, cuts);
+        m_finalDeadline = 0;
+
+        auto now    = std::chrono::steady_clock::now();
+        int  roundMs = static_cast<int>(std::chrono::duration_cast<std::chrono::milliseconds>(
+            now - start).count()) / rounds;
+        if (now > deadline) {
+            // Only known to take longer than the budget: grow it, until
+            // the model is skipped altogether.
+            ++m_finalOverBudget;
+            m_finalPassMs = static_cast<int>(budgetMs * FINAL_BUDGET_SLACK);
+            result.clear();
+        } else if (!m_cancelled) {
+            ++m_finalUsed;
+            m_finalPassMs = expectMs > 0 ? (expectMs + roundMs) / 2 : roundMs;
+        }
+    }
+
+    // Over budget (or no accurate model) with speech the partials never
+    // saw: the streaming model decodes the tail about as fast as a partial.
+    if (result.empty() && stale && !m_cancelled) {
+        m_abortInference = false;
+        result = cuts.empty()
+            ? RunWhisper(m_whisperCtx, tail, /*partial=*/false)
+            : DecodePieces(m_whisperCtx, m_fastStates, cuts);
+    }
+
+    if (m_cancelled || result.empty())
+        return;
+    pending = DropRepeatedPrefix(m_confirmedText, result);
+}
+
+std::string Transcriber::DecodePieces(whisper_context* ctx, WhisperStatePool& pool,
+                                      const std::vector<size_t>& cuts)
+{
+    std::vector<size_t> bounds = {0};
+    bounds.insert(bounds.end(), cuts.begin(), cuts.end());
+    bounds.push_back(m_pcmScratch.size());
+    const size_t pieces = bounds.size() - 1;
+
+    // Share the inference threads out between a few states of the one
+    // model; each piece fits a single encoder window, so a decode needs
+    // no seeking.  A pool that can't grow just means fewer at a time.
+    const int threads = InferenceThreads();
+    size_t want = std::min<size_t>({pieces, MAX_PIECE_STATES,
+                                    static_cast<size_t>(std::max(1, threads / MIN_PIECE_THREADS))});
+    size_t slots = pool.Reserve(ctx, want);
+    if (slots == 0) return "";
+    slots = std::min(slots, want);
+    const int perSlot = std::max(1, threads / static_cast<int>(slots));
+
+    // Only the first piece follows the committed text; the others start
+    // cold rather than wait for the text before them.
+    std::vector<std::string> texts(pieces);
+    std::atomic<size_t>      next{0};
+    std::atomic<bool>        failed{false};
+    auto decode = [&](size_t slot) {
+        whisper_state* state = pool[slot];
+        for (size_t i; !failed && (i = next++) < pieces; ) {
+            whisper_full_params params = InferenceParams(ctx, /*partial=*/false);
+            params.n_threads = perSlot;
+            if (i > 0) {
+                params.prompt_tokens   = nullptr;
+                params.prompt_n_tokens = 0;
+            }
+            const float* pcm = m_pcmScratch.data() + bounds[i];
+            int          n   = static_cast<int>(bounds[i + 1] - bounds[i]);
+            if (whisper_full_with_state(ctx, state, params, pcm, n) != 0) {
+                failed = true;
+                return;
+            }
+            std::string text;
+            int nSeg = whisper_full_n_segments_from_state(state);
+            for (int s = 0; s < nSeg; ++s)
+                if (const char* seg = whisper_full_get_segment_text_from_state(state, s))
+                    text += seg;
+            texts[i] = trimmed(text);
+        }
+    };
+
+    std::vector<std::thread> helpers;
+    for (size_t slot = 1; slot < slots; ++slot)
+        helpers.emplace_back([&, slot] {
+            if (m_placement)
+                m_placement->ApplyToCurrentThread(ThreadRole::Inference);
+            decode(slot);
+        });
+    decode(0);
+    for (auto& t : helpers) t.join();
+
+    if (failed || m_abortInference || m_cancelled)
+        return "";
+    std::string result;
+    for (const auto& text : texts)
+        result = joined(result, text);
+    return result;
+}
+
+uint64_t Transcriber::BeginTrace(bool isFinal) {
+    using Clock = LatencyMonitor::Clock;
+    return m_latency.Begin(Clock::time_point(Clock::duration(m_windowCaptured)),
+                           Clock::now(), isFinal);
+}
+
+void Transcriber::Deliver(const std::string& text, bool isFinal, uint64_t trace) {
+    m_latency.Mark(trace, LatencyMonitor::Dispatched);
+    std::lock_guard<std::mutex> lk(m_cbMutex);
+    if (m_callback)
+        m_callback(text, isFinal);
+}
+
+void Transcriber::DeliverCommand(int index, const std::string& heard) {
+    std::lock_guard<std::mutex> lk(m_cbMutex);
+    if (m_commandCallback)
+        m_commandCallback(index, heard);
+}
+
 // ============================================================================
 // Whisper inference helper
 // ============================================================================
 
-std::string Transcriber::RunWhisper(const std::vector<float>& audio, bool partial) {
-    if (!m_whisperCtx || audio.empty()) return "";
-
+whisper_full_params Transcriber::InferenceParams(whisper_context* ctx, bool partial) {
     whisper_full_params params =
         whisper_full_default_params(WHISPER_SAMPLING_GREEDY);
     params.print_progress   = false;
@@ -268,32 +1244,141 @@ std::string Transcriber::RunWhisper(const std::vector<float>& audio, bool partia
     params.print_timestamps = false;
     params.single_segment   = partial;   // faster for partial previews
     params.language         = "en";
-    params.n_threads        = inferenceThreadCount();
+    params.n_threads        = InferenceThreads();
 
-    // Allow aborting inference when the user cancels or stops
+    // Allow aborting inference when the user cancels or stops, or when
+    // the final pass runs past its budget.
     params.abort_callback = [](void* data) -> bool {
-        return static_cast<Transcriber*>(data)->m_abortInference.load();
+        auto* self = static_cast<Transcriber*>(data);
+        if (self->m_abortInference.load() || self->m_cancelled.load()) return true;
+        auto deadline = self->m_finalDeadline.load();
+        return deadline != 0
+            && std::chrono::steady_clock::now().time_since_epoch().count() > deadline;
     };
     params.abort_callback_user_data = this;
 
-    if (whisper_full(m_whisperCtx, params,
-                     audio.data(), static_cast<int>(audio.size())) != 0)
+    // whisper 1.5.5 has no per-call timings API, so its callbacks stand
+    // in: the encoder-begin hook marks the start of encoding, the first
+    // logits filter call the start of decoding.
+    params.encoder_begin_callback = [](whisper_context*, whisper_state*, void* data) {
+        auto* self = static_cast<Transcriber*>(data);
+        if (uint64_t trace = self->m_activeTrace.load())
+            self->m_latency.Mark(trace, LatencyMonitor::EncodeBegin);
+        return true;
+    };
+    params.encoder_begin_callback_user_data = this;
+    params.logits_filter_callback = [](whisper_context*, whisper_state*,
+                                       const whisper_token_data* tokens, int nTokens,
+                                       float* logits, void* data) {
+        auto* self = static_cast<Transcriber*>(data);
+        if (uint64_t trace = self->m_activeTrace.load())
+            self->m_latency.Mark(trace, LatencyMonitor::DecodeBegin);
+        if (self->m_activeGrammar)
+            self->m_activeGrammar->Constrain(tokens, nTokens, logits);
+    };
+    params.logits_filter_callback_user_data = this;
+
+    // Condition on what's already been committed so casing, punctuation
+    // and spelling stay consistent across windows.  The tokens are
+    // cached per commit, not re-tokenized every pass, and belong to the
+    // streaming model's vocabulary.  m_finalCtx is only read once
+    // m_finalReady says the load thread is done writing it.
+    const bool finalCtx = m_finalReady.load() && ctx == m_finalCtx;
+    const std::vector<int32_t>* prompt = ctx == m_whisperCtx ? &m_promptTokens
+                                       : finalCtx            ? &m_finalPromptTokens
+                                       :                       nullptr;
+    if (prompt && !prompt->empty()) {
+        params.prompt_tokens   = prompt->data();
+        params.prompt_n_tokens = static_cast<int>(prompt->size());
+    }
+    return params;
+}
+
+std::string Transcriber::RunWhisper(whisper_context* ctx, const AudioView& audio,
+                                    bool partial, std::vector<TimedText>* segments,
+                                    bool fromMel)
+{
+    if (!ctx || audio.empty()) return "";
+
+    whisper_full_params params = InferenceParams(ctx, partial);
+
+    // The encoder's cost grows with its context, not with the audio, and
+    // by default that's always 30 s.  Partials only need to cover what's
+    // buffered, so a 1.5 s command encodes 3.8 s instead.  Final passes
+    // keep the full context for accuracy.
+    if (partial && m_adaptiveContext)
+        params.audio_ctx = adaptiveAudioCtx(ctx, audio.size());
+
+    // Command decodes: the grammar decides when the text ends, so no
+    // timestamps and no temperature fallback re-decoding the clip.
+    if (m_activeGrammar) {
+        params.no_timestamps   = true;
+        params.temperature_inc = 0.0f;
+        m_activeGrammar->BeginDecode();
+    }
+
+    // Per-token timing is only needed when the caller wants to know
+    // where in the audio each piece of text lies.
+    params.token_timestamps = segments != nullptr;
+
+#ifdef WHISPER_AGENT_INCREMENTAL_MEL
+    // Between two partials the window only grows by one scheduler step,
+    // yet whisper_full() would redo the FFT of all of it.  Hand it the
+    // spectrogram m_mel has been extending instead (whisper skips its own
+    // when given no samples).  The snapshot includes whisper's 30 s of
+    // silence padding; duration_ms keeps the decoder off that padding.
+    fromMel = fromMel && m_melUsable && m_mel.WindowSamples() == audio.size();
+#else
+    fromMel = false;
+#endif
+
+    int rc;
+    if (fromMel) {
+        int nLen = m_mel.Snapshot(m_melInput);
+        params.duration_ms = static_cast<int>(audio.size() * 1000 / WHISPER_SAMPLE_RATE);
+        rc = whisper_set_mel(ctx, m_melInput.data(), nLen, m_mel.NumMels());
+        if (rc == 0)
+            rc = whisper_full(ctx, params, nullptr, 0);
+    } else {
+        // Views of m_store are chunked (and maybe 16-bit): convert just
+        // the decoded range, once, into a reused buffer.  The load
+        // thread's warmup and calibration pass plain vectors, which are
+        // used in place.
+        const float* pcm = audio.Data();
+        if (!pcm) {
+            m_pcmScratch.resize(audio.size());
+            audio.CopyTo(m_pcmScratch.data());
+            pcm = m_pcmScratch.data();
+        }
+        rc = whisper_full(ctx, params, pcm, static_cast<int>(audio.size()));
+    }
+    if (rc != 0)
         return "";
 
     std::string result;
-    int nSeg = whisper_full_n_segments(m_whisperCtx);
+    int nSeg = whisper_full_n_segments(ctx);
+    const whisper_token eot = whisper_token_eot(ctx);
     for (int i = 0; i < nSeg; ++i) {
-        const char* seg = whisper_full_get_segment_text(m_whisperCtx, i);
+        const char* seg = whisper_full_get_segment_text(ctx, i);
         if (seg) result += seg;
-    }
 
-    // Trim whitespace
-    auto s = result.find_first_not_of(" \t\n\r");
-    auto e = result.find_last_not_of(" \t\n\r");
-    if (s != std::string::npos && e != std::string::npos)
-        result = result.substr(s, e - s + 1);
-    else
-        result.clear();
+        if (!segments || !seg) continue;
+        TimedText timed;
+        timed.text  = seg;
+        timed.start = timestampToSample(whisper_full_get_segment_t0(ctx, i));
+        timed.end   = timestampToSample(whisper_full_get_segment_t1(ctx, i));
 
-    return result;
+        int nTok = whisper_full_n_tokens(ctx, i);
+        for (int j = 0; j < nTok; ++j) {
+            whisper_token_data tok = whisper_full_get_token_data(ctx, i, j);
+            if (tok.id >= eot) continue;   // timestamps and other specials
+            const char* piece = whisper_full_get_token_text(ctx, i, j);
+            if (!piece) continue;
+            timed.words.push_back({piece, timestampToSample(tok.t0),
+                                   timestampToSample(tok.t1), {}});
+        }
+        segments->push_back(std::move(timed));
+    }
+
+    return trimmed(result);
 }
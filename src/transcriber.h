@@ -1,29 +1,144 @@
 #pragma once
 
+#include <cstdint>
 #include <string>
 #include <vector>
+#include <memory>
 #include <mutex>
 #include <thread>
 #include <atomic>
 #include <functional>
 #include <condition_variable>
 
-#include <miniaudio.h>
+#include "audio_front_end.h"
+#include "audio_ring_buffer.h"
+#include "audio_store.h"
+#include "capture_source.h"
+#include "command_grammar.h"
+#include "incremental_mel.h"
+#include "inference_worker.h"
+#include "latency_monitor.h"
+#include "partial_scheduler.h"
+#include "voice_activity.h"
+#include "whisper_state_pool.h"
 
 struct whisper_context;
+struct whisper_full_params;
+class ThreadPlacement;
 
 class Transcriber {
 public:
+    enum class ModelState { Loading, Calibrating, Ready, Failed };
+
     Transcriber();
     ~Transcriber();
 
-    bool Init(const std::string& modelPath);
+    /// Start loading the model on a background thread.  Returns false
+    /// only if the file can't be opened; load errors are reported
+    /// through the model callback.  Recording may start before loading
+    /// finishes — audio is buffered until the model is ready.
+    /// @param finalModelPath  Optional slower, more accurate model used
+    ///                        for the final pass when recording stops.
+    bool Init(const std::string& modelPath, const std::string& finalModelPath = "");
+
+    /// Inference thread count.  0 (the default) means "calibrate": the
+    /// warmup after loading times several thread counts and keeps the
+    /// fastest.  Call before Init().
+    void SetThreadCount(int n) { m_threadCount = n; }
+    int  ThreadCount() const { return m_threadCount.load(); }
+
+    /// Run the models in a child process instead — @p workerPath is the
+    /// whisper-agent-worker executable.  Capture stays here and streams
+    /// into the worker through shared memory.  Cancel and shutdown kill a
+    /// worker stuck in a pass instead of waiting for it, and a crash in
+    /// whisper costs a model reload rather than the app.  Latency traces
+    /// aren't collected in this mode.  Call before Init().
+    void SetWorkerPath(const std::string& workerPath) { m_workerPath = workerPath; }
+
+    /// Where to run the audio and inference threads.  Optional; call
+    /// before Init().  Must outlive the Transcriber.
+    void SetThreadPlacement(ThreadPlacement* placement) { m_placement = placement; }
+
+    /// True if ThreadCount() came from a calibration run that the caller
+    /// may want to persist.
+    bool WasCalibrated() const { return m_calibrated.load(); }
 
+    /// True while the background thread is still loading, warming up
+    /// or calibrating (including the final-pass model).
+    bool IsLoading() const { return m_loadBusy.load(); }
+
+    /// True once the model failed to load; no session can start.
+    bool LoadFailed() const { return m_loadFailed.load(); }
+
+    /// Re-run calibration on the loaded model in the background.
+    /// Returns false if recording or still loading.
+    bool Recalibrate();
+
+    /// Record from the default capture device.
     void StartRecording();
-    void StopRecording();              // stop mic + skip final pass (non-blocking)
-    void CancelRecording();            // same as Stop but semantically "discard"
+
+    /// Record from @p source — the microphone, or a file or pipe replayed
+    /// through the same capture path (tests, benchmarks, headless use).
+    /// Returns false if the source can't be opened or started.
+    bool StartRecording(std::unique_ptr<CaptureSource> source);
+
+    /// Listen on the default capture device for one short spoken command
+    /// from the vocabulary (see SetCommandVocabulary).  The session ends
+    /// by itself once the speaker pauses; the result arrives through the
+    /// command callback, after which CancelRecording() releases the
+    /// device.  Returns false if a session can't start.
+    bool StartCommand();
+    bool StartCommand(std::unique_ptr<CaptureSource> source);
+
+    /// Phrases StartCommand() listens for.  Call while no session runs.
+    void SetCommandVocabulary(const std::vector<std::string>& phrases);
+
+    /// Words to steer recognition toward — a project's file names and
+    /// identifiers, most important first.  Tokenized once per change
+    /// (per model) into the start of the prompt every pass reuses.
+    /// Thread-safe; a dictation in progress picks it up at its next pass.
+    void SetGlossary(const std::vector<std::string>& terms);
+
+    /// True once a finite source (a file) has delivered all its audio.
+    /// Stop the recording to get the final result.
+    bool CaptureFinished() const;
+
+    /// Automatic gain control on captured audio (default on).  Takes
+    /// effect at the next recording.
+    void SetAutoGain(bool on) { m_autoGain = on; }
+
+    /// Keep session audio as 16-bit samples (half the memory, converted
+    /// back to float per pass).  Takes effect at the next recording.
+    void SetCompactAudio(bool on) { m_compactAudio = on; }
+
+    /// Size the encoder context of partial passes to the audio they
+    /// decode instead of whisper's fixed 30 s (default on).  Final
+    /// passes always use the full context.
+    void SetAdaptiveContext(bool on) { m_adaptiveContext = on; }
+
+    /// Samples lost because the streaming thread fell too far behind.
+    size_t DroppedSamples() const { return m_captureRing.Dropped(); }
+
+    /// How the accurate model's final passes went since Init().
+    struct FinalPassStats {
+        size_t used       = 0;   // finished within budget; its text was kept
+        size_t overBudget = 0;   // aborted at the deadline, text thrown away
+        size_t skipped    = 0;   // not tried: expected to miss the budget
+    };
+    FinalPassStats FinalStats() const {
+        return {m_finalUsed.load(), m_finalOverBudget.load(), m_finalSkipped.load()};
+    }
+
+    /// Stop the mic (non-blocking).  Returns true if a final result will
+    /// follow through the callback with is_final = true.
+    bool StopRecording();
+    void CancelRecording();            // stop mic, skip the final pass, discard
     bool IsRecording() const { return m_recording.load(); }
 
+    /// True while a session's streaming thread still runs (including its
+    /// final pass).
+    bool IsBusy() const { return !m_threadDone.load(); }
+
     /// Callback receives (transcribed_text, is_final).
     /// Called from a background thread.
     void SetCallback(std::function<void(const std::string&, bool)> cb) {
@@ -31,27 +146,205 @@ public:
         m_callback = std::move(cb);
     }
 
+    /// Callback receives (index into the command vocabulary or -1 if
+    /// nothing matched, text heard) when a command session ends.  Called
+    /// from a background thread.
+    void SetCommandCallback(std::function<void(int, const std::string&)> cb) {
+        std::lock_guard<std::mutex> lk(m_cbMutex);
+        m_commandCallback = std::move(cb);
+    }
+
+    /// Callback receives (state, percent) while the model loads; percent
+    /// is only meaningful for Loading.  Called from a background thread.
+    void SetModelCallback(std::function<void(ModelState, int)> cb) {
+        std::lock_guard<std::mutex> lk(m_cbMutex);
+        m_modelCallback = std::move(cb);
+    }
+
+    /// Per-stage latency of recent passes.  The transcription callback
+    /// can tag its event with Latency().LastDispatched(); the receiver
+    /// marks Delivered/Displayed and calls Finish().
+    LatencyMonitor& Latency() { return m_latency; }
+
+    /// Diagnostic hook: receives (inference_seconds, samples_decoded)
+    /// after each partial pass.  Called from the streaming thread.
+    void SetPassObserver(std::function<void(double, size_t)> cb) {
+        std::lock_guard<std::mutex> lk(m_cbMutex);
+        m_passObserver = std::move(cb);
+    }
+
 private:
-    static void AudioDataCallback(ma_device* pDevice, void* pOutput,
-                                  const void* pInput, ma_uint32 frameCount);
+    /// Text with its position in the decoded audio, in samples.
+    struct TimedText {
+        std::string            text;
+        int64_t                start = 0;
+        int64_t                end   = 0;
+        std::vector<TimedText> words;   // per-token pieces (segments only)
+    };
+
+    /// The glossary tokenized for one model, and the version it was
+    /// tokenized from.
+    struct GlossaryCache {
+        uint64_t             version = 0;
+        std::vector<int32_t> tokens;
+    };
+
+    /// Capture sink: condition and queue a source's frames.  Runs on the
+    /// source's thread (real-time for the device).
+    void OnCapturedFrames(const float* frames, size_t count);
+
+    /// Join any previous session and reset per-session state.  Returns
+    /// false if a session can't start.
+    bool BeginSession();
+
+    /// Open and start @p source and the streaming thread.  @p command
+    /// selects a command session instead of dictation.
+    bool StartSession(std::unique_ptr<CaptureSource> source, bool command);
+
+    /// Worker mode: start the worker process.  Its model states arrive
+    /// through OnWorkerLine like local ones.
+    bool InitWorker();
+
+    /// Worker command line for the current settings.
+    std::vector<std::string> WorkerArgs() const;
+
+    /// Worker mode: forward the session's frames to the worker.
+    bool StartWorkerSession();
+
+    /// A line from the worker (its reader thread).
+    void OnWorkerLine(const std::string& line);
+
+    /// The worker is gone.  Returns true to start a new one.
+    bool OnWorkerExit(bool killed);
+
+    /// Close a worker session that won't produce a result of its own:
+    /// deliver the last text it sent as final.
+    void FinishWorkerSession();
+
+    /// Background thread: load the models, then run warmup inferences.
+    void LoadModel(const std::string& modelPath, const std::string& finalModelPath);
+
+    void NotifyModelState(ModelState state, int percent);
+
+    /// Threads per whisper call: the calibrated count, capped to the
+    /// CPUs inference is pinned to.
+    int InferenceThreads() const;
+
+    /// Time a probe inference at several thread counts and keep the
+    /// fastest in m_threadCount.  Doubles as the warmup.  Load thread.
+    void Calibrate();
 
     /// Background thread: periodically transcribes while recording.
     void StreamingLoop();
 
+    /// Streaming thread body of a command session: wait for one short
+    /// utterance, decode it against m_commandGrammar and report it.
+    void CommandLoop();
+
     /// Run whisper inference on audio samples.
-    /// @param partial  If true, uses single-segment mode for speed.
-    std::string RunWhisper(const std::vector<float>& audio, bool partial);
+    /// @param partial   If true, uses single-segment mode for speed.
+    /// @param segments  If non-null, receives each segment with token timing.
+    /// @param fromMel   @p audio is the streaming window: decode m_mel's
+    ///                  spectrogram of it instead of recomputing one.
+    std::string RunWhisper(whisper_context* ctx, const AudioView& audio,
+                           bool partial, std::vector<TimedText>* segments = nullptr,
+                           bool fromMel = false);
+
+    /// Settings every decode shares: threads, abort and latency hooks,
+    /// the grammar filter and the prompt for @p ctx.
+    whisper_full_params InferenceParams(whisper_context* ctx, bool partial);
+
+    /// Decode m_pcmScratch cut at @p cuts, the pieces concurrently on
+    /// states from @p pool, and join their text in order.  Empty if any
+    /// piece failed or was aborted.
+    std::string DecodePieces(whisper_context* ctx, WhisperStatePool& pool,
+                             const std::vector<size_t>& cuts);
+
+    /// Re-transcribe the window — the audio since the last commit — with
+    /// the accurate model, seeded with the committed text, within a
+    /// budget derived from its measured pass time (m_finalPassMs); it is
+    /// skipped when even FINAL_BUDGET_MAX_MS wouldn't do.  If that fails
+    /// and @p stale says the partials missed speech, the fast model
+    /// decodes it instead.  A window too
+    /// long for one encoder pass is cut at pauses and decoded in pieces
+    /// (see DecodePieces).  Replaces @p pending (the window's last
+    /// partial text) only when a pass completes.
+    void FinalPass(std::string& pending, bool stale);
+
+    /// Invoke the transcription callback.  @p trace is the latency trace
+    /// of the pass that produced @p text (0 = none).
+    void Deliver(const std::string& text, bool isFinal, uint64_t trace = 0);
+
+    /// Invoke the command callback.
+    void DeliverCommand(int index, const std::string& heard);
 
-    /// Stop the audio device (idempotent).
-    void StopDevice();
+    /// Open a latency trace for a pass over the window as drained so far.
+    uint64_t BeginTrace(bool isFinal);
 
-    whisper_context* m_whisperCtx = nullptr;
+    /// Decode a full window with timestamps and commit it up to the last
+    /// complete segment (or word, if that segment is too long).
+    /// @p pendingText receives the uncommitted remainder.  Returns the
+    /// sample index in @p audio where that remainder starts.
+    size_t CommitWindow(const AudioView& audio, std::string& pendingText);
 
-    ma_device m_device     = {};
-    bool      m_deviceInit = false;
+    /// Move everything the audio callback has captured since the last
+    /// call into m_store (extending the window) and run it through the
+    /// VAD.  Returns true if the new samples contain speech.  Streaming
+    /// thread only.
+    bool DrainCapture();
+
+    /// The current streaming window: m_store from m_windowStart on.
+    AudioView Window() const { return m_store.Snapshot(m_windowStart, m_store.End()); }
+    size_t    WindowSamples() const { return m_store.End() - m_windowStart; }
+
+    /// The window, padded with silence to the shortest clip whisper
+    /// decodes (into m_paddedAudio) if it's shorter.
+    AudioView PaddedWindow();
+
+    /// Drop roughly @p count samples from the front of the window, rounded
+    /// down to a mel hop so m_mel's frames stay aligned.  Streaming thread only.
+    void DropWindowFront(size_t count);
+
+    /// Append @p text to m_confirmedText (no-op for empty text).
+    void CommitText(const std::string& text);
+
+    /// Re-tokenize the tail of m_confirmedText into m_promptTokens.
+    void UpdatePromptTokens();
+
+    /// Tokens of the tail of m_confirmedText in @p ctx's vocabulary.
+    /// Prefixed with GlossaryTokens(ctx, glossary).  Empty for a null
+    /// @p ctx.
+    std::vector<int32_t> PromptTokens(whisper_context* ctx, GlossaryCache& glossary);
+
+    /// The glossary in @p ctx's vocabulary, cached in @p cache (the one
+    /// belonging to @p ctx's model) and re-tokenized only when it has
+    /// changed.  Empty for a null @p ctx.  Streaming thread only.
+    const std::vector<int32_t>& GlossaryTokens(whisper_context* ctx, GlossaryCache& cache);
+
+    /// Stop the capture source (idempotent).
+    void StopSource();
+
+    whisper_context*     m_whisperCtx = nullptr;  // fast model: partials and commits
+    whisper_context*     m_finalCtx   = nullptr;  // accurate model: final pass
+    std::atomic<bool>    m_finalReady{false};
+    std::atomic<int64_t> m_finalDeadline{0};      // steady_clock ticks; 0 = no deadline
+    std::atomic<int>     m_finalPassMs{0};        // expected accurate pass; 0 = not measured
+    std::atomic<size_t>  m_finalUsed{0};
+    std::atomic<size_t>  m_finalOverBudget{0};
+    std::atomic<size_t>  m_finalSkipped{0};
+    WhisperStatePool     m_fastStates;            // long finals: concurrent decodes of m_whisperCtx
+    WhisperStatePool     m_finalStates;           // ... and of m_finalCtx
+
+    std::unique_ptr<CaptureSource> m_source;       // current session's audio; UI thread
+
+    AudioFrontEnd         m_frontEnd;              // capture source's thread
+    AudioRingBuffer       m_captureRing;           // audio thread → streaming thread
+    VoiceActivityDetector m_vad;                   // streaming thread only
+    PartialScheduler      m_scheduler;             // streaming thread only; kept across sessions
+    IncrementalMel        m_mel;                   // streaming thread only; spectrogram of the window
+    std::vector<float>    m_melInput;              // whisper_set_mel() input, reused per pass
+    std::atomic<bool>     m_melUsable{false};      // model's mel bins match m_mel
 
-    std::vector<float> m_audioBuffer;
-    std::mutex         m_audioMutex;
     std::atomic<bool>  m_recording{false};
     std::atomic<bool>  m_cancelled{false};        // true → skip final pass entirely
     std::atomic<bool>  m_abortInference{false};   // true → whisper_full returns early
@@ -61,11 +354,67 @@ private:
     std::mutex              m_stopMutex;
     std::condition_variable m_stopCv;
 
-    std::string m_confirmedText;           // accumulated text from committed chunks
+    // Streaming thread only.  m_store holds the window; audio before it
+    // is released as the window slides.
+    AudioStore           m_store;
+    size_t               m_windowStart = 0;  // absolute index in m_store
+    std::vector<float>   m_drainBuffer;      // ring → store staging, reused
+    std::vector<float>   m_pcmScratch;       // float copy of a chunked view for whisper
+    std::vector<float>   m_paddedAudio;      // short window padded for whisper, reused
+    std::atomic<bool>    m_compactAudio{false};
+    std::atomic<bool>    m_autoGain{true};
+    std::atomic<bool>    m_adaptiveContext{true};
+    std::string          m_confirmedText;  // text locked in from earlier windows
+    std::vector<int32_t> m_promptTokens;   // whisper tokens of its tail, refreshed per commit
+    std::vector<int32_t> m_finalPromptTokens;  // ... in the accurate model's vocabulary, per final pass
+
+    // Project glossary: set from any thread, tokenized on the streaming
+    // thread for each model when its version moves on.
+    std::mutex            m_glossaryMutex;
+    std::string           m_glossary;            // " term, term, ..."; guarded by m_glossaryMutex
+    std::string           m_glossaryList;        // tab-separated, for a worker; ... same
+    std::atomic<uint64_t> m_glossaryVersion{0};
+    GlossaryCache         m_fastGlossary;        // streaming thread only
+    GlossaryCache         m_finalGlossary;       // ... accurate model
 
     std::function<void(const std::string&, bool)> m_callback;
+    std::function<void(ModelState, int)>          m_modelCallback;
+    std::function<void(double, size_t)>           m_passObserver;
+    std::function<void(int, const std::string&)>  m_commandCallback;
     std::mutex                                    m_cbMutex;
 
-    std::thread             m_warmupThread;          // runs a throwaway inference at startup
-    std::atomic<bool>       m_warmupDone{false};     // true once warmup inference finishes
+    std::thread             m_loadThread;            // loads the model, then runs a warmup inference
+    std::atomic<bool>       m_warmupDone{false};     // true once load + warmup finished (or load failed)
+    std::atomic<bool>       m_loadFailed{false};
+    std::atomic<int>        m_threadCount{0};        // 0 → calibrate after load
+    std::atomic<bool>       m_calibrated{false};
+    std::atomic<bool>       m_loadBusy{false};       // load thread still running
+    std::atomic<bool>       m_shutdown{false};       // destructor has started
+
+    LatencyMonitor          m_latency;
+    std::atomic<int64_t>    m_lastCaptureTick{0};    // steady_clock ticks of the newest captured block
+    int64_t                 m_windowCaptured = 0;    // ... as of the last DrainCapture (streaming thread)
+    std::atomic<uint64_t>   m_activeTrace{0};        // trace whisper's callbacks mark; 0 = none
+
+    // Command sessions.  The vocabulary is set on the UI thread between
+    // sessions and turned into a grammar by the streaming thread.
+    bool                     m_commandMode = false;      // set before the streaming thread starts
+    std::vector<std::string> m_commandPhrases;
+    std::atomic<bool>        m_commandsChanged{false};
+    CommandGrammar           m_commandGrammar;           // streaming thread only
+    CommandGrammar*          m_activeGrammar = nullptr;  // constrains RunWhisper; streaming thread only
+
+    ThreadPlacement*        m_placement = nullptr;
+    std::atomic<bool>       m_audioPlaced{false};    // audio thread placed this session
+
+    // Worker mode (SetWorkerPath): the models live in the worker; this
+    // side only captures and relays.
+    std::string                      m_workerPath;
+    std::string                      m_modelPath;
+    std::string                      m_finalModelPath;
+    std::mutex                       m_workerMutex;           // m_worker's pointer vs SetGlossary()
+    std::unique_ptr<InferenceWorker> m_worker;
+    std::atomic<bool>                m_workerReady{false};    // current worker has its model loaded
+    std::atomic<bool>                m_workerSession{false};  // a session's result is still due
+    std::string                      m_workerText;            // latest text it sent; under m_cbMutex
 };
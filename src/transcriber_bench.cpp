@@ -0,0 +1,385 @@
+// Offline replay benchmark for the Transcriber streaming pipeline.
+//
+// Replays every <name>.wav in a fixtures folder through the same
+// capture path and streaming loop the app uses (real-time or
+// accelerated, via FileCaptureSource), then compares
+// the final text against <name>.txt.  Reports time-to-first-partial,
+// per-pass inference latency, real-time factor and word error rate.
+// Time to first partial is wall time, so it isn't scaled by --speed: a
+// faster replay reaches the first speech sooner, but the pass itself
+// takes as long as it would live.
+//
+// --ctx-guard replays everything twice, with partials encoded over a
+// context sized to their audio and over whisper's full 30 s, and fails
+// if the adaptive context costs more than WER_GUARD_POINTS of WER in the
+// last partial transcript (finals always use the full context, so only
+// the partials, and the text they commit, can differ).
+//
+//   whisper-agent-bench <fixtures-dir> [--speed X] [--threads N]
+//                       [--model PATH] [--final-model PATH | --no-final]
+//                       [--int16] [--no-agc] [--full-context | --ctx-guard]
+
+#include "transcriber.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+static constexpr int    SAMPLE_RATE      = 16000;
+static constexpr int    POLL_MS          = 10;
+static constexpr int    FINAL_TIMEOUT_MS = 30000;
+static constexpr double WER_GUARD_POINTS = 0.5;     // --ctx-guard: allowed partial WER increase
+
+// ============================================================================
+// Helpers
+// ============================================================================
+
+static double secondsSince(Clock::time_point t0, Clock::time_point t1) {
+    return std::chrono::duration<double>(t1 - t0).count();
+}
+
+static std::string readFile(const fs::path& path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+static std::vector<std::string> normalizedWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::string cur;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '\'') {
+            cur += static_cast<char>(std::tolower(c));
+        } else if (!cur.empty()) {
+            words.push_back(cur);
+            cur.clear();
+        }
+    }
+    if (!cur.empty()) words.push_back(cur);
+    return words;
+}
+
+/// Word-level Levenshtein distance (substitutions + insertions + deletions).
+static size_t wordErrors(const std::vector<std::string>& ref,
+                         const std::vector<std::string>& hyp)
+{
+    std::vector<size_t> prev(hyp.size() + 1), cur(hyp.size() + 1);
+    for (size_t j = 0; j <= hyp.size(); ++j) prev[j] = j;
+    for (size_t i = 1; i <= ref.size(); ++i) {
+        cur[0] = i;
+        for (size_t j = 1; j <= hyp.size(); ++j) {
+            size_t sub = prev[j - 1] + (ref[i - 1] == hyp[j - 1] ? 0 : 1);
+            cur[j] = std::min({sub, prev[j] + 1, cur[j - 1] + 1});
+        }
+        std::swap(prev, cur);
+    }
+    return prev[hyp.size()];
+}
+
+static double percentile(std::vector<double> v, double p) {
+    if (v.empty()) return 0.0;
+    std::sort(v.begin(), v.end());
+    size_t idx = static_cast<size_t>(p * (v.size() - 1) + 0.5);
+    return v[std::min(idx, v.size() - 1)];
+}
+
+// ============================================================================
+// One fixture
+// ============================================================================
+
+struct FixtureResult {
+    double              audioSec      = 0.0;
+    double              firstPartial  = -1.0;   // wall seconds from start, -1 = none
+    double              finalizeSec   = 0.0;    // Stop → final text
+    std::vector<double> passSec;
+    size_t              passSamples   = 0;
+    size_t              refWords      = 0;
+    size_t              finalErrors   = 0;
+    size_t              partialErrors = 0;
+    size_t              dropped       = 0;
+    std::string         finalText;
+};
+
+static bool runFixture(Transcriber& tr, const fs::path& wav, const std::string& reference,
+                       double speed, FixtureResult& res)
+{
+    std::mutex              mtx;
+    std::condition_variable cv;
+    bool                    gotFinal = false;
+    std::string             lastPartial;
+    Clock::time_point       start, stopped, finalAt;
+
+    tr.SetCallback([&](const std::string& text, bool isFinal) {
+        std::lock_guard<std::mutex> lk(mtx);
+        auto now = Clock::now();
+        if (isFinal) {
+            res.finalText = text;
+            finalAt       = now;
+            gotFinal      = true;
+            cv.notify_all();
+        } else {
+            lastPartial = text;
+            if (res.firstPartial < 0 && !text.empty())
+                res.firstPartial = secondsSince(start, now);
+        }
+    });
+    tr.SetPassObserver([&](double sec, size_t samples) {
+        std::lock_guard<std::mutex> lk(mtx);
+        res.passSec.push_back(sec);
+        res.passSamples += samples;
+    });
+
+    FileCaptureSource::Options opts;
+    opts.speed = speed;
+    auto source = std::make_unique<FileCaptureSource>(wav.string(), opts);
+    FileCaptureSource* replay = source.get();   // owned by tr until the next session
+
+    start = Clock::now();
+    if (!tr.StartRecording(std::move(source))) {
+        tr.SetCallback(nullptr);
+        tr.SetPassObserver(nullptr);
+        return false;
+    }
+    while (!tr.CaptureFinished())
+        std::this_thread::sleep_for(std::chrono::milliseconds(POLL_MS));
+    res.dropped  = tr.DroppedSamples();
+    res.audioSec = static_cast<double>(replay->FramesDelivered()) / replay->SampleRate();
+
+    stopped = Clock::now();
+    if (tr.StopRecording()) {
+        std::unique_lock<std::mutex> lk(mtx);
+        cv.wait_for(lk, std::chrono::milliseconds(FINAL_TIMEOUT_MS), [&] { return gotFinal; });
+    }
+
+    std::lock_guard<std::mutex> lk(mtx);
+    if (!gotFinal) res.finalText = lastPartial;
+    res.finalizeSec = gotFinal ? secondsSince(stopped, finalAt) : -1.0;
+
+    auto ref = normalizedWords(reference);
+    res.refWords      = ref.size();
+    res.finalErrors   = wordErrors(ref, normalizedWords(res.finalText));
+    res.partialErrors = wordErrors(ref, normalizedWords(lastPartial));
+
+    tr.SetCallback(nullptr);
+    tr.SetPassObserver(nullptr);
+    return true;
+}
+
+// ============================================================================
+// Fixture suite
+// ============================================================================
+
+struct Summary {
+    std::vector<double> passes;
+    double              totalAudio      = 0.0;
+    double              totalPassSec    = 0.0;
+    double              firstSum        = 0.0;
+    size_t              firstCount      = 0;
+    size_t              totalRef        = 0;
+    size_t              totalFinalErr   = 0;
+    size_t              totalPartialErr = 0;
+    Transcriber::FinalPassStats finals;
+
+    double FinalWer() const { return totalRef ? 100.0 * totalFinalErr / totalRef : 0.0; }
+    double PartialWer() const { return totalRef ? 100.0 * totalPartialErr / totalRef : 0.0; }
+};
+
+/// Replay every fixture, printing a row each.  False if none had a
+/// reference to score against.
+static bool runSuite(Transcriber& tr, const std::vector<fs::path>& wavs, double speed,
+                     Summary& sum)
+{
+    std::printf("%-28s %7s %9s %8s %8s %7s %9s %9s\n",
+                "fixture", "audio", "1st wall", "p50", "p95", "rtf", "finalize", "wer");
+    const Transcriber::FinalPassStats before = tr.FinalStats();
+
+    for (auto& wav : wavs) {
+        fs::path refPath = wav;
+        refPath.replace_extension(".txt");
+        FixtureResult r;
+        if (!fs::exists(refPath) || !runFixture(tr, wav, readFile(refPath), speed, r)) {
+            std::fprintf(stderr, "skipping %s (missing reference or unreadable)\n",
+                         wav.filename().string().c_str());
+            continue;
+        }
+
+        double passTotal = 0.0;
+        for (double p : r.passSec) passTotal += p;
+        double rtf = r.passSamples ? passTotal / (static_cast<double>(r.passSamples) / SAMPLE_RATE) : 0.0;
+        double wer = r.refWords ? static_cast<double>(r.finalErrors) / r.refWords : 0.0;
+
+        char first[16] = "n/a";
+        if (r.firstPartial >= 0)
+            std::snprintf(first, sizeof first, "%.0fms", r.firstPartial * 1000.0);
+        char finalize[16] = "n/a";
+        if (r.finalizeSec >= 0)
+            std::snprintf(finalize, sizeof finalize, "%.0fms", r.finalizeSec * 1000.0);
+
+        std::printf("%-28s %6.1fs %9s %6.0fms %6.0fms %7.3f %9s %8.1f%%%s\n",
+                    wav.filename().string().c_str(), r.audioSec, first,
+                    percentile(r.passSec, 0.5) * 1000.0,
+                    percentile(r.passSec, 0.95) * 1000.0,
+                    rtf, finalize, wer * 100.0,
+                    r.dropped ? "  (dropped audio!)" : "");
+
+        sum.passes.insert(sum.passes.end(), r.passSec.begin(), r.passSec.end());
+        sum.totalAudio      += r.audioSec;
+        sum.totalPassSec    += passTotal;
+        sum.totalRef        += r.refWords;
+        sum.totalFinalErr   += r.finalErrors;
+        sum.totalPartialErr += r.partialErrors;
+        if (r.firstPartial >= 0) {
+            sum.firstSum += r.firstPartial;
+            ++sum.firstCount;
+        }
+    }
+    const Transcriber::FinalPassStats after = tr.FinalStats();
+    sum.finals.used       = after.used - before.used;
+    sum.finals.overBudget = after.overBudget - before.overBudget;
+    sum.finals.skipped    = after.skipped - before.skipped;
+    return sum.totalRef > 0;
+}
+
+static void printSummary(const Summary& sum) {
+    std::printf("\nsummary over %.1f s of audio, %zu partial passes\n", sum.totalAudio, sum.passes.size());
+    std::printf("  time to first partial  mean %.0f ms (wall clock)\n",
+                sum.firstCount ? sum.firstSum / sum.firstCount * 1000.0 : 0.0);
+    std::printf("  partial pass latency   p50 %.0f ms   p95 %.0f ms   max %.0f ms\n",
+                percentile(sum.passes, 0.5) * 1000.0, percentile(sum.passes, 0.95) * 1000.0,
+                percentile(sum.passes, 1.0) * 1000.0);
+    std::printf("  inference time / audio %.3f\n",
+                sum.totalAudio > 0 ? sum.totalPassSec / sum.totalAudio : 0.0);
+    std::printf("  WER final              %.2f%%\n", sum.FinalWer());
+    std::printf("  WER partials only      %.2f%%\n", sum.PartialWer());
+    std::printf("  accurate final passes  %zu kept   %zu over budget   %zu skipped\n",
+                sum.finals.used, sum.finals.overBudget, sum.finals.skipped);
+}
+
+// ============================================================================
+// main
+// ============================================================================
+
+static void usage(const char* argv0) {
+    std::fprintf(stderr,
+        "usage: %s <fixtures-dir> [--speed X] [--threads N]\n"
+        "          [--model PATH] [--final-model PATH | --no-final] [--int16]\n"
+        "          [--no-agc] [--full-context | --ctx-guard]\n"
+        "\n"
+        "Each <name>.wav in the folder needs a reference <name>.txt.\n"
+        "--speed 1 replays in real time (default); higher values replay faster.\n"
+        "--int16 stores session audio as 16-bit samples, like the app's compact mode.\n"
+        "--no-agc turns off automatic gain control on the replayed audio.\n"
+        "--full-context encodes partials over whisper's full 30 s context.\n"
+        "--ctx-guard runs with the full and the adaptive context and fails if\n"
+        "  the adaptive one raises the partial-transcript WER by more than\n"
+        "  %.1f points.\n",
+        argv0, WER_GUARD_POINTS);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    fs::path    dir        = argv[1];
+    double      speed      = 1.0;
+    int         threads    = 0;
+    std::string model      = WHISPER_MODEL_PATH;
+    std::string finalModel = WHISPER_FINAL_MODEL_PATH;
+    bool        compact    = false;
+    bool        autoGain   = true;
+    bool        adaptive   = true;
+    bool        guard      = false;
+
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* {
+            if (i + 1 >= argc) { usage(argv[0]); std::exit(2); }
+            return argv[++i];
+        };
+        if      (arg == "--speed")        speed      = std::atof(next());
+        else if (arg == "--threads")      threads    = std::atoi(next());
+        else if (arg == "--model")        model      = next();
+        else if (arg == "--final-model")  finalModel = next();
+        else if (arg == "--no-final")     finalModel.clear();
+        else if (arg == "--int16")        compact    = true;
+        else if (arg == "--no-agc")       autoGain   = false;
+        else if (arg == "--full-context") adaptive   = false;
+        else if (arg == "--ctx-guard")    guard      = true;
+        else { usage(argv[0]); return 2; }
+    }
+    if (speed <= 0.0) speed = 1.0;
+
+    std::vector<fs::path> wavs;
+    if (fs::is_directory(dir))
+        for (auto& e : fs::directory_iterator(dir))
+            if (e.path().extension() == ".wav") wavs.push_back(e.path());
+    std::sort(wavs.begin(), wavs.end());
+    if (wavs.empty()) {
+        std::fprintf(stderr, "no .wav fixtures in %s\n", dir.string().c_str());
+        return 1;
+    }
+
+    // Load and warm up (or calibrate) before timing anything.
+    Transcriber tr;
+    tr.SetThreadCount(threads);
+    tr.SetCompactAudio(compact);
+    tr.SetAutoGain(autoGain);
+    tr.SetAdaptiveContext(adaptive);
+    auto loadStart = Clock::now();
+    if (!tr.Init(model, finalModel)) {
+        std::fprintf(stderr, "cannot open model %s\n", model.c_str());
+        return 1;
+    }
+    while (tr.IsLoading())
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    std::printf("model: %s\nfinal: %s\nthreads: %d   load+warmup: %.2f s   speed: %.1fx\n\n",
+                model.c_str(), finalModel.empty() ? "(none)" : finalModel.c_str(),
+                tr.ThreadCount(), secondsSince(loadStart, Clock::now()), speed);
+
+    if (!guard) {
+        Summary sum;
+        if (!runSuite(tr, wavs, speed, sum)) return 1;
+        printSummary(sum);
+        return 0;
+    }
+
+    // Accuracy guard: the same fixtures with the full context as the
+    // baseline, then adaptive.
+    Summary fullCtx, adaptiveCtx;
+    std::printf("-- full 30 s context --\n");
+    tr.SetAdaptiveContext(false);
+    if (!runSuite(tr, wavs, speed, fullCtx)) return 1;
+    printSummary(fullCtx);
+    std::printf("\n-- adaptive context --\n");
+    tr.SetAdaptiveContext(true);
+    if (!runSuite(tr, wavs, speed, adaptiveCtx)) return 1;
+    printSummary(adaptiveCtx);
+
+    double p50Full = percentile(fullCtx.passes, 0.5), p50Adaptive = percentile(adaptiveCtx.passes, 0.5);
+    double delta   = adaptiveCtx.PartialWer() - fullCtx.PartialWer();
+    std::printf("\nadaptive vs full context\n");
+    std::printf("  partial pass p50       %.0f ms -> %.0f ms (%.1fx)\n",
+                p50Full * 1000.0, p50Adaptive * 1000.0,
+                p50Adaptive > 0.0 ? p50Full / p50Adaptive : 0.0);
+    std::printf("  WER final              %+.2f points\n",
+                adaptiveCtx.FinalWer() - fullCtx.FinalWer());
+    std::printf("  WER partials only      %+.2f points (limit +%.2f)  %s\n",
+                delta, WER_GUARD_POINTS, delta <= WER_GUARD_POINTS ? "ok" : "FAIL");
+    return delta <= WER_GUARD_POINTS ? 0 : 1;
+}
@@ -0,0 +1,20 @@
+#include "transcript_mailbox.h"
+
+bool TranscriptMailbox::Post(const std::string& text, bool isFinal, uint64_t trace) {
+    std::lock_guard<std::mutex> lk(m_mutex);
+    bool wake = m_pending.empty();
+
+    // The waiting partial is stale now; its latency trace ages out.
+    if (!m_pending.empty() && !m_pending.back().isFinal)
+        m_pending.back() = Update{text, isFinal, trace};
+    else
+        m_pending.push_back(Update{text, isFinal, trace});
+    return wake;
+}
+
+std::vector<TranscriptMailbox::Update> TranscriptMailbox::TakeAll() {
+    std::vector<Update> out;
+    std::lock_guard<std::mutex> lk(m_mutex);
+    out.swap(m_pending);
+    return out;
+}
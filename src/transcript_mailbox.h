@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/// Hand-off of transcription results from the streaming thread to the UI.
+///
+/// Every partial carries the full text so far, so only the newest one
+/// matters: a partial posted while the previous one is still waiting
+/// replaces it instead of queueing behind it.  Finals are never
+/// replaced.  Post() reports when the mailbox goes from empty to
+/// non-empty, so the producer wakes the UI once per batch no matter how
+/// far behind it is.  Thread-safe.
+class TranscriptMailbox {
+public:
+    struct Update {
+        std::string text;
+        bool        isFinal = false;
+        uint64_t    trace   = 0;   // LatencyMonitor trace of the pass, 0 = none
+    };
+
+    /// Store an update.  Returns true if the mailbox was empty, i.e. the
+    /// reader needs waking.
+    bool Post(const std::string& text, bool isFinal, uint64_t trace);
+
+    /// Everything waiting, oldest first: at most one partial per final.
+    std::vector<Update> TakeAll();
+
+private:
+    std::mutex          m_mutex;
+    std::vector<Update> m_pending;
+};
@@ -0,0 +1,48 @@
+#include "transcript_text.h"
+
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <vector>
+
+static constexpr int MAX_OVERLAP_WORDS = 8;   // longest repeat we look for
+
+static std::vector<std::string> splitWords(const std::string& text) {
+    std::vector<std::string> words;
+    std::istringstream in(text);
+    for (std::string w; in >> w; )
+        words.push_back(w);
+    return words;
+}
+
+/// Case- and punctuation-insensitive form of a word for overlap matching.
+static std::string normalizedWord(const std::string& word) {
+    std::string out;
+    for (unsigned char c : word)
+        if (std::isalnum(c)) out += static_cast<char>(std::tolower(c));
+    return out;
+}
+
+std::string DropRepeatedPrefix(const std::string& confirmed, const std::string& text) {
+    if (confirmed.empty() || text.empty()) return text;
+
+    auto tail  = splitWords(confirmed);
+    auto words = splitWords(text);
+    int maxK = std::min({MAX_OVERLAP_WORDS, static_cast<int>(tail.size()),
+                         static_cast<int>(words.size())});
+
+    for (int k = maxK; k > 0; --k) {
+        bool match = true;
+        for (int i = 0; i < k && match; ++i)
+            match = normalizedWord(tail[tail.size() - k + i]) == normalizedWord(words[i]);
+        if (!match) continue;
+
+        std::string rest;
+        for (size_t i = k; i < words.size(); ++i) {
+            if (!rest.empty()) rest += ' ';
+            rest += words[i];
+        }
+        return rest;
+    }
+    return text;
+}
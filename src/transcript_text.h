@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+
+/// The overlap audio kept across a commit makes whisper re-transcribe
+/// the last few committed words at the start of the next window.  Drop
+/// the longest prefix of @p text (up to eight words) that repeats the
+/// tail of @p confirmed, comparing words without case or punctuation.
+std::string DropRepeatedPrefix(const std::string& confirmed, const std::string& text);
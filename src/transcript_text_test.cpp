@@ -0,0 +1,45 @@
+// Checks DropRepeatedPrefix(), the overlap de-duplication between a
+// committed window and the next one.
+//
+// Each case gives the committed text, what whisper made of the next
+// window (which re-hears the overlap), and what should be appended.
+//
+//   whisper-agent-text-test
+
+#include "transcript_text.h"
+
+#include <cstdio>
+
+static int failures = 0;
+
+static void check(const char* confirmed, const char* text, const char* want, const char* what) {
+    std::string got = DropRepeatedPrefix(confirmed, text);
+    bool ok = got == want;
+    std::printf("%s %-42s \"%s\"\n", ok ? "ok  " : "FAIL", what, got.c_str());
+    if (!ok) {
+        std::printf("     expected \"%s\"\n", want);
+        ++failures;
+    }
+}
+
+int main() {
+    check("open the main file", "main file and save it", "and save it",
+          "two repeated words dropped");
+    check("we should ship it.", "Ship it, then tag the release", "then tag the release",
+          "case and punctuation ignored");
+    check("the cat sat on the mat", "the dog ran", "the dog ran",
+          "a match only at the very tail counts");
+    check("go to line ten", "ten ten more lines", "ten more lines",
+          "only the overlap, not a repeat after it");
+    check("a b c d e f g h i j", "b c d e f g h i j k", "b c d e f g h i j k",
+          "a nine-word overlap is not looked for");
+    check("a b c d e f g h i j", "d e f g h i j k", "k",
+          "eight-word overlap dropped");
+    check("all of it", "all of it", "",
+          "a window that only repeats leaves nothing");
+    check("", "first words", "first words",
+          "nothing committed yet");
+    check("nothing shared", "  spaced   out  ", "  spaced   out  ",
+          "no overlap leaves the text untouched");
+    return failures ? 1 : 0;
+}
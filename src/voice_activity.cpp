@@ -0,0 +1,131 @@
+#include "voice_activity.h"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr float SPEECH_MARGIN_DB  = 10.0f;   // above noise floor
+static constexpr float LOUD_MARGIN_DB    = 20.0f;   // overrides the ZCR guard
+static constexpr float ABS_MIN_DB        = -50.0f;  // never speech below this
+static constexpr float NOISE_ZCR         = 0.45f;   // crossings per sample
+static constexpr float FLOOR_RISE        = 0.005f;  // ~4 s time constant
+static constexpr int   ONSET_FRAMES      = 2;       // 40 ms to enter speech
+static constexpr int   HANGOVER_FRAMES   = 10;      // 200 ms to leave speech
+static constexpr int   PAUSE_FRAMES      = 15;      // 300 ms scored as one cut
+
+void VoiceActivityDetector::Reset() {
+    m_frameFill     = 0;
+    m_noiseFloorDb  = 0.0f;
+    m_floorInit     = false;
+    m_onsetRun      = 0;
+    m_hangover      = 0;
+    m_silentSamples = 0;
+    m_heardSpeech   = false;
+}
+
+bool VoiceActivityDetector::Process(const float* samples, size_t count) {
+    bool speech = false;
+    while (count > 0) {
+        size_t n = std::min(count, static_cast<size_t>(FRAME_SAMPLES - m_frameFill));
+        std::copy(samples, samples + n, m_frame + m_frameFill);
+        m_frameFill += static_cast<int>(n);
+        samples     += n;
+        count       -= n;
+
+        if (m_frameFill < FRAME_SAMPLES) break;
+        m_frameFill = 0;
+
+        if (ClassifyFrame()) {
+            speech          = true;
+            m_heardSpeech   = true;
+            m_silentSamples = 0;
+        } else {
+            m_silentSamples += FRAME_SAMPLES;
+        }
+    }
+    return speech;
+}
+
+bool VoiceActivityDetector::ClassifyFrame() {
+    float energy = 0.0f;
+    int   crossings = 0;
+    for (int i = 0; i < FRAME_SAMPLES; ++i) {
+        energy += m_frame[i] * m_frame[i];
+        if (i > 0 && (m_frame[i] >= 0.0f) != (m_frame[i - 1] >= 0.0f))
+            ++crossings;
+    }
+    float db  = 10.0f * std::log10(energy / FRAME_SAMPLES + 1e-10f);
+    float zcr = static_cast<float>(crossings) / FRAME_SAMPLES;
+
+    if (!m_floorInit) {
+        m_noiseFloorDb = db;
+        m_floorInit    = true;
+    }
+
+    bool loud = db > m_noiseFloorDb + SPEECH_MARGIN_DB && db > ABS_MIN_DB;
+    if (loud && zcr > NOISE_ZCR && db < m_noiseFloorDb + LOUD_MARGIN_DB)
+        loud = false;   // broadband hiss, not voice
+
+    // Track the noise floor: follow drops immediately, rise slowly and
+    // only outside speech so a long utterance doesn't raise it.
+    if (db < m_noiseFloorDb)
+        m_noiseFloorDb = db;
+    else if (!loud && m_hangover == 0)
+        m_noiseFloorDb += (db - m_noiseFloorDb) * FLOOR_RISE;
+    m_noiseFloorDb = std::max(m_noiseFloorDb, -90.0f);
+
+    m_onsetRun = loud ? m_onsetRun + 1 : 0;
+    if (m_onsetRun >= ONSET_FRAMES || (loud && m_hangover > 0)) {
+        m_hangover = HANGOVER_FRAMES;
+        return true;
+    }
+    if (m_hangover > 0)
+        --m_hangover;
+    return false;
+}
+
+std::vector<size_t> FindPauseCuts(const float* samples, size_t count,
+                                  size_t minPiece, size_t maxPiece)
+{
+    constexpr size_t FRAME = VoiceActivityDetector::FRAME_SAMPLES;
+    std::vector<size_t> cuts;
+    if (count <= maxPiece || maxPiece < 2 * FRAME) return cuts;
+    minPiece = std::clamp(minPiece, FRAME, maxPiece / 2);
+
+    // Prefix sums of frame energy, so any PAUSE_FRAMES run scores in O(1).
+    const size_t frames = count / FRAME;
+    std::vector<double> energy(frames + 1, 0.0);
+    for (size_t f = 0; f < frames; ++f) {
+        double e = 0.0;
+        for (size_t i = 0; i < FRAME; ++i) {
+            float s = samples[f * FRAME + i];
+            e += s * s;
+        }
+        energy[f + 1] = energy[f] + e;
+    }
+    auto runEnergy = [&](size_t center) {
+        size_t lo = center >= PAUSE_FRAMES / 2 ? center - PAUSE_FRAMES / 2 : 0;
+        size_t hi = std::min(frames, lo + PAUSE_FRAMES);
+        return energy[hi] - energy[lo];
+    };
+
+    // Greedily place each cut in the quietest spot between minPiece and
+    // maxPiece after the previous one, leaving at least minPiece after it.
+    size_t start = 0;
+    while (count - start > maxPiece) {
+        size_t lo = (start + minPiece) / FRAME;
+        size_t hi = std::min(start + maxPiece, count - minPiece) / FRAME;
+        if (hi < lo) hi = lo;
+        size_t best = hi;
+        double bestEnergy = runEnergy(hi);
+        for (size_t f = lo; f < hi; ++f) {
+            double e = runEnergy(f);
+            if (e < bestEnergy) {
+                bestEnergy = e;
+                best       = f;
+            }
+        }
+        start = best * FRAME;
+        cuts.push_back(start);
+    }
+    return cuts;
+}
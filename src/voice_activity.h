@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/// Cheap energy / zero-crossing voice activity detector.
+///
+/// Samples are split into 20 ms frames.  A frame counts as speech when
+/// its energy is well above an adaptive noise floor.  Frames with a very
+/// high zero-crossing rate are treated as hiss unless they're loud.  A
+/// short onset requirement rejects clicks, and a hangover bridges the
+/// gaps between words.
+class VoiceActivityDetector {
+public:
+    static constexpr int FRAME_SAMPLES = 320;   // 20 ms at 16 kHz
+
+    VoiceActivityDetector() { Reset(); }
+
+    void Reset();
+
+    /// Feed 16 kHz mono samples.  Returns true if any complete frame in
+    /// them was classified as speech.
+    bool Process(const float* samples, size_t count);
+
+    /// True while inside speech (including the hangover period).
+    bool InSpeech() const { return m_hangover > 0; }
+
+    /// Samples fed since the last speech frame.  Grows without bound
+    /// until speech has been heard at least once.
+    size_t TrailingSilence() const { return m_silentSamples; }
+
+    /// True once any speech has been detected since Reset().
+    bool HeardSpeech() const { return m_heardSpeech; }
+
+private:
+    bool ClassifyFrame();
+
+    float  m_frame[FRAME_SAMPLES];
+    int    m_frameFill     = 0;
+
+    float  m_noiseFloorDb  = 0.0f;
+    bool   m_floorInit     = false;
+    int    m_onsetRun      = 0;      // consecutive loud frames
+    int    m_hangover      = 0;      // frames left before leaving speech
+    size_t m_silentSamples = 0;
+    bool   m_heardSpeech   = false;
+};
+
+/// Where to cut @p count samples of a recording into pieces no longer
+/// than @p maxPiece (and, except for a short recording, no shorter than
+/// @p minPiece).  Each cut lands in the quietest 300 ms its range allows
+/// — between sentences, if the speaker paused.  Returns the positions of
+/// the cuts, ascending; empty if the recording fits in one piece.
+std::vector<size_t> FindPauseCuts(const float* samples, size_t count,
+                                  size_t minPiece, size_t maxPiece);
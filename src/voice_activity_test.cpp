@@ -0,0 +1,116 @@
+// Checks VoiceActivityDetector's onset and hangover.
+//
+// After a second of faint noise to settle the floor, speech must start
+// only after ONSET_FRAMES loud frames in a row (a single click is
+// ignored), must bridge a short gap between words, and must end once
+// HANGOVER_FRAMES of quiet have passed.  Loud broadband hiss near the
+// floor is not speech.
+//
+//   whisper-agent-vad-test
+
+#include "voice_activity.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+static constexpr int    SAMPLE_RATE     = 16000;
+static constexpr int    FRAME           = VoiceActivityDetector::FRAME_SAMPLES;
+static constexpr int    ONSET_FRAMES    = 2;      // voice_activity.cpp
+static constexpr int    HANGOVER_FRAMES = 10;
+static constexpr float  NOISE_LEVEL     = 0.01f;  // floor about -51 dB
+static constexpr float  VOICE_LEVEL     = 0.2f;
+
+static int failures = 0;
+
+static void check(bool ok, const char* what) {
+    std::printf("%s %s\n", ok ? "ok  " : "FAIL", what);
+    if (!ok) ++failures;
+}
+
+static uint32_t seed = 4242;
+
+static float noise() {
+    seed = seed * 1664525u + 1013904223u;
+    return static_cast<float>(seed >> 8) / (1u << 24) - 0.5f;
+}
+
+static std::vector<float> quiet(int frames) {
+    std::vector<float> v(static_cast<size_t>(frames) * FRAME);
+    for (float& s : v) s = NOISE_LEVEL * noise();
+    return v;
+}
+
+/// A voiced 180 Hz tone, well above the floor and low in zero crossings.
+static std::vector<float> voice(int frames) {
+    std::vector<float> v(static_cast<size_t>(frames) * FRAME);
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i] = VOICE_LEVEL * static_cast<float>(std::sin(2.0 * M_PI * 180.0 * i / SAMPLE_RATE))
+             + NOISE_LEVEL * noise();
+    return v;
+}
+
+/// Alternating-sign noise: nearly every sample crosses zero.
+static std::vector<float> hiss(int frames, float level) {
+    std::vector<float> v(static_cast<size_t>(frames) * FRAME);
+    for (size_t i = 0; i < v.size(); ++i)
+        v[i] = level * (0.5f + std::fabs(noise())) * (i % 2 ? 1.0f : -1.0f);
+    return v;
+}
+
+/// Feed one frame at a time; the first frame Process() called speech, or -1.
+static int firstSpeechFrame(VoiceActivityDetector& vad, const std::vector<float>& pcm) {
+    for (size_t f = 0; f * FRAME < pcm.size(); ++f)
+        if (vad.Process(pcm.data() + f * FRAME, FRAME))
+            return static_cast<int>(f);
+    return -1;
+}
+
+/// Feed one frame at a time; how many frames InSpeech() stayed true.
+static int framesInSpeech(VoiceActivityDetector& vad, const std::vector<float>& pcm) {
+    int n = 0;
+    for (size_t f = 0; f * FRAME < pcm.size(); ++f) {
+        vad.Process(pcm.data() + f * FRAME, FRAME);
+        if (!vad.InSpeech()) break;
+        ++n;
+    }
+    return n;
+}
+
+static void settle(VoiceActivityDetector& vad) {
+    vad.Reset();
+    auto floor = quiet(SAMPLE_RATE / FRAME);
+    vad.Process(floor.data(), floor.size());
+}
+
+int main() {
+    VoiceActivityDetector vad;
+
+    settle(vad);
+    check(!vad.HeardSpeech() && !vad.InSpeech(), "noise alone is not speech");
+
+    auto click = voice(1);
+    auto after = quiet(20);
+    click.insert(click.end(), after.begin(), after.end());
+    check(firstSpeechFrame(vad, click) < 0, "a single loud frame is rejected");
+
+    settle(vad);
+    check(firstSpeechFrame(vad, voice(10)) == ONSET_FRAMES - 1, "speech starts on the onset frame");
+
+    // A gap shorter than the hangover stays inside speech, and the next
+    // word keeps it there.
+    int gap = framesInSpeech(vad, quiet(HANGOVER_FRAMES - 2));
+    check(gap == HANGOVER_FRAMES - 2, "a short pause is bridged");
+    check(firstSpeechFrame(vad, voice(3)) == 0, "the next word continues at once");
+
+    int tail = framesInSpeech(vad, quiet(HANGOVER_FRAMES * 3));
+    check(tail == HANGOVER_FRAMES - 1, "speech ends after the hangover");
+    check(vad.HeardSpeech() && vad.TrailingSilence() >= static_cast<size_t>(HANGOVER_FRAMES) * FRAME,
+          "trailing silence counts from the last speech frame");
+
+    settle(vad);
+    check(firstSpeechFrame(vad, hiss(20, NOISE_LEVEL * 3)) < 0, "hiss near the floor is rejected");
+
+    return failures ? 1 : 0;
+}
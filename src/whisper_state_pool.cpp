@@ -0,0 +1,28 @@
+#include "whisper_state_pool.h"
+
+#include <whisper.h>
+
+size_t WhisperStatePool::Reserve(whisper_context* ctx, size_t count) {
+    if (ctx != m_ctx) {
+        Clear();
+        m_ctx = ctx;
+    }
+    while (m_ctx && m_states.size() < count) {
+        whisper_state* state = whisper_init_state(m_ctx);
+        if (!state) break;
+        m_states.push_back(state);
+    }
+    return m_states.size();
+}
+
+void WhisperStatePool::Clear() {
+    for (whisper_state* state : m_states)
+        whisper_free_state(state);
+    m_states.clear();
+    m_ctx = nullptr;
+}
+
+void WhisperStatePool::Abandon() {
+    m_states.clear();
+    m_ctx = nullptr;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+struct whisper_context;
+struct whisper_state;
+
+/// Extra decoder states for one loaded model.
+///
+/// A whisper_context holds the weights plus one default state (KV caches,
+/// compute buffers); whisper_full() can only run one decode on it at a
+/// time.  Each whisper_state from the pool lets another decode run
+/// concurrently against the same weights, so the model is loaded once.
+/// States are created on first use and kept for the next call — they
+/// cost tens to hundreds of MB each, depending on the model.
+class WhisperStatePool {
+public:
+    WhisperStatePool() = default;
+    ~WhisperStatePool() { Clear(); }
+
+    WhisperStatePool(const WhisperStatePool&) = delete;
+    WhisperStatePool& operator=(const WhisperStatePool&) = delete;
+
+    /// Make at least @p count states for @p ctx available (fewer if
+    /// whisper can't allocate more).  Switching to another context frees
+    /// the old states first.  Returns how many there are.
+    size_t Reserve(whisper_context* ctx, size_t count);
+
+    whisper_state* operator[](size_t i) const { return m_states[i]; }
+    size_t         Size() const { return m_states.size(); }
+
+    /// Free every state.  Call before freeing the context.
+    void Clear();
+
+    /// Forget the states without freeing them — a decode that can't be
+    /// interrupted still uses them, and the process is exiting anyway.
+    void Abandon();
+
+private:
+    whisper_context*            m_ctx = nullptr;
+    std::vector<whisper_state*> m_states;
+};
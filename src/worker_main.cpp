@@ -0,0 +1,173 @@
+// Out-of-process inference worker.
+//
+// Runs a Transcriber for whisper-agent in its own process, so the app can
+// kill it mid-pass and survive it crashing.  Not meant to be started by
+// hand: the app passes the audio ring as descriptor 3 and talks to it over
+// stdin/stdout (see InferenceWorker for the protocol).
+//
+//   whisper-agent-worker <model> [--final-model PATH] [--threads N]
+//                        [--int16] [--no-agc] [--placement]
+//                        [--no-realtime-audio] [--inference-cores N]
+//                        [--cpus LIST]
+//                        [--full-context]
+
+#include "inference_worker.h"
+#include "thread_placement.h"
+#include "transcriber.h"
+
+#include <sys/prctl.h>
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+static constexpr int IDLE_POLL_MS = 5;
+
+/// Result lines go out from the streaming, load and main threads.
+class Output {
+public:
+    void Send(const std::string& line) {
+        std::lock_guard<std::mutex> lk(m_mutex);
+        std::fwrite(line.data(), 1, line.size(), stdout);
+        std::fputc('\n', stdout);
+        std::fflush(stdout);
+    }
+
+private:
+    std::mutex m_mutex;
+};
+
+static std::vector<std::string> splitTabs(const std::string& text) {
+    std::vector<std::string> parts;
+    std::istringstream in(text);
+    for (std::string p; std::getline(in, p, '\t'); )
+        if (!p.empty()) parts.push_back(p);
+    return parts;
+}
+
+/// "0,1,4" → {0, 1, 4}.
+static std::vector<int> parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::istringstream in(text);
+    for (std::string p; std::getline(in, p, ','); )
+        if (!p.empty()) cpus.push_back(std::atoi(p.c_str()));
+    return cpus;
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "usage: %s <model> [options]  (started by whisper-agent)\n", argv[0]);
+        return 2;
+    }
+
+    std::string             model = argv[1];
+    std::string             finalModel;
+    int                     threads  = 0;
+    bool                    compact  = false;
+    bool                    autoGain = true;
+    bool                    adaptive = true;
+    ThreadPlacement::Policy policy;
+    for (int i = 2; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto next = [&]() -> const char* { return i + 1 < argc ? argv[++i] : ""; };
+        if      (arg == "--final-model")       finalModel            = next();
+        else if (arg == "--threads")           threads               = std::atoi(next());
+        else if (arg == "--int16")             compact               = true;
+        else if (arg == "--no-agc")            autoGain              = false;
+        else if (arg == "--placement")         policy.enabled        = true;
+        else if (arg == "--no-realtime-audio") policy.realtimeAudio  = false;
+        else if (arg == "--inference-cores")   policy.inferenceCores = std::atoi(next());
+        else if (arg == "--cpus")              policy.cpus           = parseCpuList(next());
+        else if (arg == "--full-context")      adaptive              = false;
+    }
+
+    // Don't outlive the app, even while blocked on a pass.
+    prctl(PR_SET_PDEATHSIG, SIGKILL);
+
+    auto ring = SharedAudioRing::Map(InferenceWorker::RING_FD);
+    if (!ring) {
+        std::fprintf(stderr, "whisper-agent-worker: no audio ring on fd %d\n",
+                     InferenceWorker::RING_FD);
+        return 1;
+    }
+
+    // Before any thread starts: Configure() moves this thread (and so
+    // every thread it creates) off the spawning thread's CPUs.
+    ThreadPlacement placement;
+    placement.Configure(policy);
+
+    Output      out;
+    Transcriber tr;
+    tr.SetThreadPlacement(&placement);
+    tr.SetThreadCount(threads);
+    tr.SetCompactAudio(compact);
+    tr.SetAutoGain(autoGain);
+    tr.SetAdaptiveContext(adaptive);
+
+    tr.SetModelCallback([&](Transcriber::ModelState state, int percent) {
+        // The thread count first, so the app can save it when Ready arrives.
+        if (state == Transcriber::ModelState::Ready)
+            out.Send("threads " + std::to_string(tr.ThreadCount()) + " "
+                     + (tr.WasCalibrated() ? "1" : "0"));
+        out.Send("model " + std::to_string(static_cast<int>(state)) + " "
+                 + std::to_string(percent));
+    });
+    tr.SetCallback([&](const std::string& text, bool isFinal) {
+        out.Send((isFinal ? "final " : "partial ") + InferenceWorker::Escape(text));
+    });
+    tr.SetCommandCallback([&](int index, const std::string& heard) {
+        out.Send("command " + std::to_string(index) + " " + InferenceWorker::Escape(heard));
+    });
+
+    if (!tr.Init(model, finalModel)) {
+        out.Send("model " + std::to_string(static_cast<int>(Transcriber::ModelState::Failed)) + " 0");
+        return 1;
+    }
+
+    for (std::string line; std::getline(std::cin, line); ) {
+        std::istringstream in(line);
+        std::string verb;
+        in >> verb;
+
+        if (verb == "start" || verb == "command") {
+            uint32_t rate = 0, channels = 0;
+            uint64_t from = 0;
+            in >> rate >> channels >> from;
+            auto source = std::make_unique<SharedRingCaptureSource>(*ring, from, rate, channels);
+            bool ok = verb == "start" ? tr.StartRecording(std::move(source))
+                                      : tr.StartCommand(std::move(source));
+            if (!ok)
+                out.Send(verb == "start" ? "nofinal" : "command -1 ");
+        } else if (verb == "stop") {
+            if (!tr.StopRecording())
+                out.Send("nofinal");
+        } else if (verb == "cancel") {
+            // The app kills us if this takes longer than its grace period.
+            tr.CancelRecording();
+            while (tr.IsBusy())
+                std::this_thread::sleep_for(std::chrono::milliseconds(IDLE_POLL_MS));
+            out.Send("idle");
+        } else if (verb == "recalibrate") {
+            if (!tr.Recalibrate())
+                out.Send("model " + std::to_string(static_cast<int>(Transcriber::ModelState::Ready))
+                         + " 100");
+        } else if (verb == "vocab") {
+            tr.SetCommandVocabulary(splitTabs(InferenceWorker::Unescape(
+                line.substr(std::min(line.size(), verb.size() + 1)))));
+        } else if (verb == "glossary") {
+            tr.SetGlossary(splitTabs(InferenceWorker::Unescape(
+                line.substr(std::min(line.size(), verb.size() + 1)))));
+        }
+    }
+
+    // The app closed its end (or is gone).  Don't wait for a pass in
+    // flight or free the models — the OS reclaims everything.
+    std::_Exit(0);
+}